@@ -0,0 +1,75 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Bump allocator: hands out memory from big blocks in order and never
+// frees anything on its own; it all goes at once with the Arena. Good for
+// arrays that live exactly as long as one piece of work, where per-array
+// malloc/free is pure overhead. Not thread-safe.
+class Arena {
+public:
+    explicit Arena(size_t block_size = 1 << 20)
+      : block_size(block_size), at(nullptr), left(0), used(0) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(at) % align) % align;
+        if (pad + bytes > left) {
+            // anything bigger than a block gets a block of its own
+            size_t n = max(block_size, bytes + align);
+            blocks.push_back(unique_ptr<char[]>(new char[n]));
+            at = blocks.back().get();
+            left = n;
+            pad = (align - reinterpret_cast<uintptr_t>(at) % align) % align;
+        }
+        char* p = at + pad;
+        at = p + bytes;
+        left -= pad + bytes;
+        used += bytes;
+        return p;
+    }
+
+    // bytes handed out so far, including memory given back by a growing
+    // array (an arena never reuses it)
+    size_t bytes_used() const { return used; }
+
+private:
+    size_t block_size;
+    vector<unique_ptr<char[]>> blocks;
+    char* at;
+    size_t left;
+    size_t used;
+};
+
+// Standard allocator over an Arena, for ResizableArray or std::vector.
+// deallocate is a no-op; the memory comes back when the Arena is destroyed,
+// so the arena has to outlive every container using it.
+template<typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena& a) : arena(&a) {}
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) {}
+
+    Arena* arena;
+};
+
+template<typename T, typename U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template<typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+#endif // ARENA_H
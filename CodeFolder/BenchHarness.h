@@ -0,0 +1,162 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include "HashTable.h"
+#include "FinalAssignment.h"
+#include <string>
+#include <vector>
+#include <ostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+// Small benchmarking harness shared by the menu experiments and TableBench:
+// warmup runs that aren't recorded, then a fixed number of timed
+// iterations summarized as min / median / p99 / mean / stddev, plus
+// throughput over however many items (tokens) one iteration handles.
+
+struct BenchConfig {
+    int warmup;
+    int iterations;
+};
+
+struct BenchStats {
+    size_t iterations;
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+    double mean_ns;
+    double stddev_ns;
+};
+
+// summary of raw per-iteration times; p99 is nearest-rank
+inline BenchStats summarize(vector<long long> ns) {
+    BenchStats s = {ns.size(), 0, 0, 0, 0, 0};
+    if (ns.empty()) return s;
+    sort(ns.begin(), ns.end());
+    size_t n = ns.size();
+    s.min_ns = static_cast<double>(ns[0]);
+    s.median_ns = (n % 2) ? ns[n / 2] : (ns[n / 2 - 1] + ns[n / 2]) / 2.0;
+    s.p99_ns = static_cast<double>(ns[min(n - 1, static_cast<size_t>(ceil(0.99 * n)) - 1)]);
+    double sum = 0;
+    for (long long v : ns) sum += v;
+    s.mean_ns = sum / n;
+    double sq = 0;
+    for (long long v : ns) sq += (v - s.mean_ns) * (v - s.mean_ns);
+    s.stddev_ns = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+    return s;
+}
+
+// run() does one iteration and returns the ns it wants counted, so it can
+// keep setup (building a table, prefilling it) out of the measurement
+template<typename Run>
+BenchStats measure(const BenchConfig& cfg, Run run) {
+    for (int i = 0; i < cfg.warmup; ++i) run();
+    vector<long long> ns;
+    for (int i = 0; i < cfg.iterations; ++i) ns.push_back(run());
+    return summarize(ns);
+}
+
+// items per second at the median time
+inline double throughput(const BenchStats& s, size_t items) {
+    return s.median_ns > 0 ? items / (s.median_ns / 1e9) : 0.0;
+}
+
+// one line of human-readable stats
+inline string format_stats(const BenchStats& s, size_t items) {
+    ostringstream out;
+    out << "median " << static_cast<long long>(s.median_ns) << " ns (min " << static_cast<long long>(s.min_ns)
+        << ", p99 " << static_cast<long long>(s.p99_ns) << ", stddev " << static_cast<long long>(s.stddev_ns)
+        << ", " << s.iterations << " runs), " << static_cast<long long>(throughput(s, items)) << " tokens/s";
+    return out.str();
+}
+
+// ns to count every token into table, with increment() or the old
+// find-then-insert pair
+template<typename Table>
+long long time_count(Table& table, const ResizableArray<string>& tokens, bool single_probe = true) {
+    auto start = chrono::high_resolution_clock::now();
+    for (const string& w : tokens) {
+        if (single_probe) {
+            table.increment(w);
+        } else {
+            int v;
+            table.find(w, v) ? table.insert(w, v + 1) : table.insert(w, 1);
+        }
+    }
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+}
+
+// time_count with the whole stream in one increment_batch call
+template<typename Table>
+long long time_count_batched(Table& table, const ResizableArray<string>& tokens) {
+    auto start = chrono::high_resolution_clock::now();
+    table.increment_batch(tokens.begin(), tokens.size());
+    auto end = chrono::high_resolution_clock::now();
+    return chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+}
+
+// One measured configuration. Fields that don't apply to a table (load
+// factor for chaining) are 0.
+struct BenchResult {
+    string sweep;
+    string table;
+    string hasher;
+    size_t table_size;
+    double load_factor;
+    size_t tokens;
+    BenchStats stats;
+};
+
+inline void write_results_text(ostream& out, const vector<BenchResult>& results) {
+    string sweep;
+    for (const BenchResult& r : results) {
+        if (r.sweep != sweep) {
+            sweep = r.sweep;
+            out << "=== sweep: " << sweep << " ===\n";
+        }
+        out << r.table << " / " << r.hasher << " / size " << r.table_size;
+        if (r.load_factor > 0) out << " / load " << r.load_factor;
+        out << " / " << r.tokens << " tokens → " << format_stats(r.stats, r.tokens) << "\n";
+    }
+}
+
+inline void write_results_csv(ostream& out, const vector<BenchResult>& results) {
+    ios::fmtflags flags = out.flags();
+    out << fixed << setprecision(2);
+    out << "sweep,table,hasher,table_size,load_factor,tokens,iterations,min_ns,median_ns,p99_ns,mean_ns,stddev_ns,tokens_per_sec\n";
+    for (const BenchResult& r : results) {
+        const BenchStats& s = r.stats;
+        out << r.sweep << ',' << r.table << ',' << r.hasher << ',' << r.table_size << ',' << r.load_factor << ','
+            << r.tokens << ',' << s.iterations << ',' << s.min_ns << ',' << s.median_ns << ',' << s.p99_ns << ','
+            << s.mean_ns << ',' << s.stddev_ns << ',' << throughput(s, r.tokens) << "\n";
+    }
+    out.flags(flags);
+}
+
+// names are fixed identifiers, nothing in them needs escaping
+inline void write_results_json(ostream& out, const vector<BenchResult>& results) {
+    ios::fmtflags flags = out.flags();
+    out << fixed << setprecision(2);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        const BenchStats& s = r.stats;
+        out << "  {\"sweep\": \"" << r.sweep << "\", \"table\": \"" << r.table << "\", \"hasher\": \"" << r.hasher
+            << "\", \"table_size\": " << r.table_size << ", \"load_factor\": " << r.load_factor
+            << ", \"tokens\": " << r.tokens << ", \"iterations\": " << s.iterations
+            << ", \"min_ns\": " << s.min_ns << ", \"median_ns\": " << s.median_ns << ", \"p99_ns\": " << s.p99_ns
+            << ", \"mean_ns\": " << s.mean_ns << ", \"stddev_ns\": " << s.stddev_ns
+            << ", \"tokens_per_sec\": " << throughput(s, r.tokens) << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+    out.flags(flags);
+}
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,645 @@
+#include "FinalAssignment.h"
+#include "TextUtils.h"
+#include "WordCounter.h"
+#include "ProbingHash.h"
+#include "MappedFile.h"
+#include "TextStream.h"
+#include "SimdText.h"
+#include "ParallelCounter.h"
+#include "StripedHash.h"
+#include "ChainingHash.h"
+#include "SwissHash.h"
+#include "SubstringSearch.h"
+#include "StringPool.h"
+#include "Arena.h"
+#include "Sections.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <type_traits>
+
+using namespace std;
+using namespace chrono;
+
+// the original O(n*u) frequency list: scan every entry for every token
+ResizableArray<pair<string,int>> linear_scan_counts(const string& text) {
+    ResizableArray<pair<string,int>> freq_list;
+    for_each_token(text, [&](string_view w) {
+        for (size_t j = 0; j < freq_list.size(); ++j) {
+            if (freq_list[j].first == w) {
+                freq_list[j].second++;
+                return;
+            }
+        }
+        freq_list.push_back(make_pair(string(w), 1));
+    });
+    return freq_list;
+}
+
+// repeat the source text until the corpus reaches target bytes
+string make_corpus(const string& source, size_t target) {
+    string corpus;
+    corpus.reserve(target);
+    while (corpus.size() < target) {
+        size_t n = min(source.size(), target - corpus.size());
+        corpus.append(source, 0, n);
+        corpus += ' ';
+    }
+    return corpus;
+}
+
+void word_count_scaling(const string& source, const ResizableArray<size_t>& sizes_kb, size_t scan_limit_kb) {
+    cout << "=== Word count scaling ===\n";
+    for (size_t i = 0; i < sizes_kb.size(); ++i) {
+        string corpus = make_corpus(source, sizes_kb[i] * 1024);
+
+        auto start = high_resolution_clock::now();
+        WordCounter counter;
+        for_each_token(corpus, [&](string_view w) { counter.add(w); });
+        auto end = high_resolution_clock::now();
+        long long hash_ns = duration_cast<nanoseconds>(end - start).count();
+        double mb = corpus.size() / (1024.0 * 1024.0);
+
+        cout << sizes_kb[i] << " KB: " << counter.total_words() << " tokens, "
+             << counter.unique_words() << " unique → WordCounter "
+             << hash_ns << " ns (" << mb / (hash_ns / 1e9) << " MB/s)";
+
+        if (sizes_kb[i] <= scan_limit_kb) {
+            start = high_resolution_clock::now();
+            auto freq_list = linear_scan_counts(corpus);
+            end = high_resolution_clock::now();
+            long long scan_ns = duration_cast<nanoseconds>(end - start).count();
+            assert(freq_list.size() == counter.unique_words());
+            cout << ", linear scan " << scan_ns << " ns (" << mb / (scan_ns / 1e9) << " MB/s)";
+        }
+        cout << endl;
+    }
+}
+
+// pseudo-random lowercase words, 3-12 letters, so the table sees a realistic
+// unbounded vocabulary instead of sequential keys
+ResizableArray<string> random_words(size_t n) {
+    ResizableArray<string> words;
+    unsigned long long x = 88172645463325252ULL;
+    for (size_t i = 0; i < n; ++i) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        string w(3 + x % 10, 'a');
+        unsigned long long bits = x;
+        for (size_t k = 0; k < w.size(); ++k) {
+            if (k % 12 == 11) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; bits = x; }
+            w[k] = 'a' + bits % 26;
+            bits /= 26;
+        }
+        words.push_back(w);
+    }
+    return words;
+}
+
+// per-insert latency while a ProbingHash grows from a tiny table through an
+// unbounded vocabulary; the incremental mode should flatten the tail
+void growth_latency(size_t num_keys) {
+    cout << "=== ProbingHash growth: per-insert latency (" << num_keys << " distinct keys) ===\n";
+    ResizableArray<string> keys = random_words(num_keys);
+
+    const char* names[] = { "full rehash", "incremental" };
+    GrowthPolicy policies[] = { GROW_REHASH, GROW_INCREMENTAL };
+    for (int p = 0; p < 2; ++p) {
+        ProbingHash<string,int> table(1009, 0.7, policies[p]);
+        ResizableArray<long long> lat;
+        long long total = 0;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            auto start = high_resolution_clock::now();
+            table.insert(keys[i], 1);
+            auto end = high_resolution_clock::now();
+            long long ns = duration_cast<nanoseconds>(end - start).count();
+            lat.push_back(ns);
+            total += ns;
+        }
+        assert(table.size() <= num_keys);
+        sort(&lat[0], &lat[0] + lat.size());
+        cout << names[p] << ": mean " << total / (long long)lat.size() << " ns"
+             << ", p50 " << lat[lat.size() / 2] << " ns"
+             << ", p99 " << lat[lat.size() * 99 / 100] << " ns"
+             << ", p99.99 " << lat[lat.size() * 9999 / 10000] << " ns"
+             << ", max " << lat[lat.size() - 1] << " ns"
+             << ", final capacity " << table.capacity() << endl;
+    }
+}
+
+// bytes/sec of the scalar tokenizer and sentence counter against every
+// SIMD kernel level this CPU supports
+void tokenizer_throughput(const string& source, size_t corpus_mb) {
+    cout << "=== Tokenizer throughput (" << corpus_mb << " MB, best kernel "
+         << simd_level_name(best_simd_level()) << ") ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+    double mb = corpus.size() / (1024.0 * 1024.0);
+
+    size_t ref_tokens = 0, ref_bytes = 0;
+    auto start = high_resolution_clock::now();
+    for_each_token(corpus, [&](string_view w) { ref_tokens++; ref_bytes += w.size(); });
+    auto end = high_resolution_clock::now();
+    long long ns = duration_cast<nanoseconds>(end - start).count();
+    cout << "for_each_token (scalar): " << mb / (ns / 1e9) << " MB/s\n";
+
+    start = high_resolution_clock::now();
+    size_t ref_sentences = count_sentences(corpus);
+    end = high_resolution_clock::now();
+    ns = duration_cast<nanoseconds>(end - start).count();
+    cout << "count_sentences (scalar): " << mb / (ns / 1e9) << " MB/s\n";
+
+    for (int l = SIMD_SCALAR; l <= best_simd_level(); ++l) {
+        SimdLevel level = static_cast<SimdLevel>(l);
+        size_t tokens = 0, bytes = 0;
+        start = high_resolution_clock::now();
+        for_each_token_simd(corpus, [&](string_view w) { tokens++; bytes += w.size(); }, level);
+        end = high_resolution_clock::now();
+        long long tok_ns = duration_cast<nanoseconds>(end - start).count();
+        assert(tokens == ref_tokens && bytes == ref_bytes);
+
+        start = high_resolution_clock::now();
+        size_t sentences = count_sentences_simd(corpus, level);
+        end = high_resolution_clock::now();
+        long long sent_ns = duration_cast<nanoseconds>(end - start).count();
+        assert(sentences == ref_sentences);
+
+        cout << "for_each_token_simd (" << simd_level_name(level) << "): " << mb / (tok_ns / 1e9) << " MB/s"
+             << ", count_sentences_simd: " << mb / (sent_ns / 1e9) << " MB/s\n";
+    }
+}
+
+// count_words_parallel from 1 thread up to every core, against the
+// sequential WordCounter it has to agree with
+void parallel_scaling(const string& source, size_t corpus_mb) {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "=== Parallel counting (" << corpus_mb << " MB, " << cores << " cores) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+
+    auto start = high_resolution_clock::now();
+    WordCounter counter;
+    for_each_token_simd(corpus, [&](string_view w) { counter.add(w); });
+    auto end = high_resolution_clock::now();
+    long long seq_ns = duration_cast<nanoseconds>(end - start).count();
+    cout << "WordCounter (sequential): " << seq_ns << " ns\n";
+    const ResizableArray<pair<string,int>>& expected = counter.counts();
+
+    long long one_ns = 0;
+    for (unsigned t = 1; t <= cores; ++t) {
+        start = high_resolution_clock::now();
+        ResizableArray<pair<string,int>> freq = count_words_parallel(corpus, t);
+        end = high_resolution_clock::now();
+        long long ns = duration_cast<nanoseconds>(end - start).count();
+        if (t == 1) one_ns = ns;
+
+        assert(freq.size() == expected.size());
+        for (size_t i = 0; i < freq.size(); ++i) assert(freq[i] == expected[i]);
+        cout << t << " thread(s): " << ns << " ns, speedup " << static_cast<double>(one_ns) / ns << "x\n";
+    }
+}
+
+// main()'s intern pass, one thread against intern_tokens_parallel from 1
+// thread up to every core; the ids, token stream, counts and index must match
+void parallel_interning(const string& source, size_t corpus_mb) {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "=== Parallel interning (" << corpus_mb << " MB, " << cores << " cores) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+
+    auto start = high_resolution_clock::now();
+    StringPool words;
+    ResizableArray<uint32_t> tokens;
+    ResizableArray<pair<uint32_t,int>> freq_list;
+    InvertedIndex index;
+    for_each_token_simd(corpus, [&](string_view w) {
+        uint32_t id = words.intern(w);
+        tokens.push_back(id);
+        if (id == freq_list.size()) freq_list.push_back(make_pair(id, 0));
+        freq_list[id].second++;
+        index.add(id);
+    });
+    auto end = high_resolution_clock::now();
+    cout << "one pass: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+
+    long long one_ns = 0;
+    for (unsigned t = 1; t <= cores; ++t) {
+        StringPool pool;
+        ResizableArray<uint32_t> ids;
+        ResizableArray<pair<uint32_t,int>> freq;
+        InvertedIndex joined;
+        start = high_resolution_clock::now();
+        intern_tokens_parallel(corpus, t, pool, ids, freq, joined);
+        end = high_resolution_clock::now();
+        long long ns = duration_cast<nanoseconds>(end - start).count();
+        if (t == 1) one_ns = ns;
+
+        assert(pool.size() == words.size() && ids.size() == tokens.size() && freq.size() == freq_list.size());
+        for (uint32_t id = 0; id < pool.size(); ++id) assert(pool.view(id) == words.view(id) && freq[id] == freq_list[id]);
+        for (size_t i = 0; i < ids.size(); ++i) assert(ids[i] == tokens[i]);
+        assert(joined.token_count() == index.token_count() && joined.unique_words() == index.unique_words());
+        for (uint32_t id = 0; id < pool.size(); ++id) {
+            InvertedIndex::Encoded a = joined.encoded(id), b = index.encoded(id);
+            assert(a.size == b.size && a.count == b.count && memcmp(a.data, b.data, a.size) == 0);
+        }
+        cout << t << " thread(s): " << ns << " ns, speedup " << static_cast<double>(one_ns) / ns << "x\n";
+    }
+}
+
+// SectionCounts from 1 thread up to every core. The corpus is the text
+// repeated, so every copy brings its own twelve chapters, like a batch of
+// documents; totals have to match a sequential count either way.
+void section_scaling(const string& source, size_t corpus_mb) {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+    auto start = high_resolution_clock::now();
+    ResizableArray<Section> found = find_sections(corpus);
+    auto end = high_resolution_clock::now();
+    cout << "=== Section-partitioned counting (" << corpus_mb << " MB, " << found.size() << " sections, "
+         << cores << " cores) ===\n";
+    cout << "heading pre-pass: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+
+    long long one_ns = 0;
+    size_t expected = 0;
+    for (unsigned t = 1; t <= cores; ++t) {
+        start = high_resolution_clock::now();
+        SectionCounts sc(corpus, t);
+        end = high_resolution_clock::now();
+        long long ns = duration_cast<nanoseconds>(end - start).count();
+        if (t == 1) {
+            one_ns = ns;
+            expected = sc.total_words(0, sc.size() - 1);
+        }
+        assert(sc.total_words(0, sc.size() - 1) == expected);
+        cout << t << " thread(s): " << ns << " ns, speedup " << static_cast<double>(one_ns) / ns << "x\n";
+    }
+}
+
+// time `threads` threads each counting a slice of tokens into one shared
+// table through bump(token)
+template<typename Bump>
+long long shared_count_time(const vector<string>& tokens, unsigned threads, Bump bump) {
+    auto start = high_resolution_clock::now();
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            size_t begin = tokens.size() * t / threads, end = tokens.size() * (t + 1) / threads;
+            for (size_t i = begin; i < end; ++i) bump(tokens[i]);
+        });
+    }
+    for (auto& w : workers) w.join();
+    auto end = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(end - start).count();
+}
+
+// Every thread increments the same table. The text's own word stream is
+// the skewed key set: a handful of words ("the", "and", "i") make up a big
+// share of all tokens, so their buckets are the hot spots.
+void shared_table_contention(const string& source, size_t corpus_mb) {
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "=== Shared table contention (" << corpus_mb << " MB, " << cores << " cores) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+    vector<string> tokens;
+    for_each_token_simd(corpus, [&](string_view w) { tokens.push_back(string(w)); });
+    WordCounter expected;
+    for (const string& w : tokens) expected.add(w);
+    cout << "\"the\" is " << 100.0 * expected.count("the") / tokens.size() << "% of "
+         << tokens.size() << " tokens\n";
+
+    const size_t TABLE_SIZE = 20011;
+    for (unsigned t = 1; t <= max(4u, cores); t *= 2) {
+        mutex global;
+        ChainingHash<string,int> chain(TABLE_SIZE);
+        long long chain_ns = shared_count_time(tokens, t, [&](const string& w) {
+            lock_guard<mutex> guard(global);
+            chain.increment(w);
+        });
+        ProbingHash<string,int> probe(TABLE_SIZE, 0.7);
+        long long probe_ns = shared_count_time(tokens, t, [&](const string& w) {
+            lock_guard<mutex> guard(global);
+            probe.increment(w);
+        });
+        StripedHash<string,int> striped(TABLE_SIZE);
+        long long striped_ns = shared_count_time(tokens, t, [&](const string& w) { striped.increment(w); });
+
+        int c1, c2, c3;
+        assert(chain.find("the", c1) && probe.find("the", c2) && striped.find("the", c3));
+        assert(c1 == expected.count("the") && c2 == c1 && c3 == c1);
+        assert(striped.size() == expected.unique_words() && probe.size() == striped.size());
+        cout << t << " thread(s): mutex+ChainingHash " << chain_ns << " ns, mutex+ProbingHash " << probe_ns
+             << " ns, StripedHash " << striped_ns << " ns\n";
+    }
+}
+
+// rolling-hash Rabin-Karp against Aho-Corasick for 1 and 8 substrings
+// over the raw corpus; both have to find the same matches
+void substring_search(const string& source, size_t corpus_mb) {
+    cout << "=== Substring search (" << corpus_mb << " MB) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+    double mb = corpus.size() / (1024.0 * 1024.0);
+    const char* all_keys[] = { "Holmes", "Irene Adler", "photograph", "Baker Street",
+                               "the King", "Watson", "Briony Lodge", "zzzz" };
+    for (size_t n : { 1, 8 }) {
+        ResizableArray<string> keys;
+        for (size_t k = 0; k < n; ++k) keys.push_back(all_keys[k]);
+
+        auto start = high_resolution_clock::now();
+        ResizableArray<SubstringMatch> rk = rabin_karp_search(corpus, keys);
+        auto end = high_resolution_clock::now();
+        long long rk_ns = duration_cast<nanoseconds>(end - start).count();
+
+        start = high_resolution_clock::now();
+        AhoCorasick automaton(keys);
+        ResizableArray<SubstringMatch> ac = automaton.search(corpus);
+        end = high_resolution_clock::now();
+        long long ac_ns = duration_cast<nanoseconds>(end - start).count();
+
+        assert(rk.size() == ac.size());
+        for (size_t i = 0; i < rk.size(); ++i) assert(rk[i].offset == ac[i].offset && rk[i].pattern == ac[i].pattern);
+        cout << n << " key(s), " << rk.size() << " matches: Rabin-Karp " << mb / (rk_ns / 1e9)
+             << " MB/s, Aho-Corasick " << mb / (ac_ns / 1e9) << " MB/s\n";
+    }
+}
+
+// token stream as one std::string per token against pool ids; string
+// bytes count the heap buffer of anything too long for the small-string
+// buffer
+void interned_tokens(const string& source, size_t corpus_mb) {
+    cout << "=== Token storage: strings vs interned ids (" << corpus_mb << " MB) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+
+    auto start = high_resolution_clock::now();
+    ResizableArray<string> strings;
+    for_each_token_simd(corpus, [&](string_view w) { strings.push_back(string(w)); });
+    auto end = high_resolution_clock::now();
+    long long string_ns = duration_cast<nanoseconds>(end - start).count();
+    size_t string_bytes = 0;
+    for (size_t i = 0; i < strings.size(); ++i) {
+        string_bytes += sizeof(string) + (strings[i].capacity() > 15 ? strings[i].capacity() + 1 : 0);
+    }
+
+    start = high_resolution_clock::now();
+    StringPool pool;
+    ResizableArray<uint32_t> ids;
+    for_each_token_simd(corpus, [&](string_view w) { ids.push_back(pool.intern(w)); });
+    end = high_resolution_clock::now();
+    long long pool_ns = duration_cast<nanoseconds>(end - start).count();
+    size_t pool_bytes = pool.bytes() + ids.size() * sizeof(uint32_t);
+
+    assert(ids.size() == strings.size());
+    for (size_t i = 0; i < ids.size(); ++i) assert(pool.view(ids[i]) == strings[i]);
+    cout << "std::string per token: " << string_ns << " ns, " << string_bytes / 1024 << " KB ("
+         << static_cast<double>(string_bytes) / strings.size() << " B/token)\n"
+         << "StringPool + u32 ids: " << pool_ns << " ns, " << pool_bytes / 1024 << " KB ("
+         << static_cast<double>(pool_bytes) / ids.size() << " B/token, " << pool.size() << " words)\n";
+}
+
+// ns to push every token of corpus into out as a string
+template<typename Array>
+long long token_fill_time(const string& corpus, Array& out) {
+    auto start = high_resolution_clock::now();
+    for_each_token_simd(corpus, [&](string_view w) { out.push_back(string(w)); });
+    auto end = high_resolution_clock::now();
+    return duration_cast<nanoseconds>(end - start).count();
+}
+
+// average ns to build a copy of the (word, count) list one push at a time
+template<typename Array, typename Make>
+long long freq_fill_time(const ResizableArray<pair<string,int>>& vocab, int runs, Make make) {
+    long long total = 0;
+    for (int r = 0; r < runs; ++r) {
+        auto start = high_resolution_clock::now();
+        Array out = make();
+        for (const auto& e : vocab) out.push_back(e);
+        auto end = high_resolution_clock::now();
+        total += duration_cast<nanoseconds>(end - start).count();
+    }
+    return total / runs;
+}
+
+// ResizableArray with the default and the arena allocator against
+// std::vector on the token stream and the frequency list
+void array_growth(const string& source, size_t corpus_mb) {
+    cout << "=== ResizableArray vs std::vector (" << corpus_mb << " MB) ===\n";
+    string corpus = make_corpus(source, corpus_mb * 1024 * 1024);
+
+    ResizableArray<string> plain;
+    long long plain_ns = token_fill_time(corpus, plain);
+    Arena token_arena;
+    ResizableArray<string, ArenaAllocator<string>> arena_tokens{ArenaAllocator<string>(token_arena)};
+    long long arena_ns = token_fill_time(corpus, arena_tokens);
+    vector<string> vec;
+    long long vec_ns = token_fill_time(corpus, vec);
+    assert(plain.size() == vec.size() && arena_tokens.size() == vec.size());
+    cout << "tokens (" << vec.size() << "): ResizableArray " << plain_ns << " ns, ResizableArray+Arena "
+         << arena_ns << " ns, std::vector " << vec_ns << " ns\n";
+
+    WordCounter counter;
+    for (const string& w : plain) counter.add(w);
+    const ResizableArray<pair<string,int>>& vocab = counter.counts();
+    const int RUNS = 100;
+    typedef pair<string,int> Entry;
+    long long plain_freq = freq_fill_time<ResizableArray<Entry>>(vocab, RUNS, [] { return ResizableArray<Entry>(); });
+    Arena freq_arena;
+    long long arena_freq = freq_fill_time<ResizableArray<Entry, ArenaAllocator<Entry>>>(vocab, RUNS, [&] {
+        return ResizableArray<Entry, ArenaAllocator<Entry>>(ArenaAllocator<Entry>(freq_arena));
+    });
+    long long vec_freq = freq_fill_time<vector<Entry>>(vocab, RUNS, [] { return vector<Entry>(); });
+    cout << "frequency list (" << vocab.size() << " words, " << RUNS << " runs): ResizableArray " << plain_freq
+         << " ns, ResizableArray+Arena " << arena_freq << " ns, std::vector " << vec_freq << " ns\n";
+}
+
+// ns per lookup of every key in keys (all hits or all misses)
+template<typename Table>
+long long lookup_ns(const Table& table, const ResizableArray<string>& keys, bool expect_hit) {
+    int v;
+    size_t hits = 0;
+    auto start = high_resolution_clock::now();
+    for (const string& k : keys) hits += table.find(k, v);
+    auto end = high_resolution_clock::now();
+    assert(hits == (expect_hit ? keys.size() : 0));
+    (void)expect_hit;
+    return duration_cast<nanoseconds>(end - start).count() / (long long)keys.size();
+}
+
+// Keep live_keys keys in the table while every round erases the oldest
+// quarter and inserts as many new ones. Without tombstone reuse and
+// compaction a probing table fills up with tombstones and lookups, misses
+// above all, get slower round after round; they should stay flat.
+template<typename Table>
+void churn_rounds(const char* name, Table& table, size_t live_keys, size_t rounds) {
+    size_t batch = live_keys / 4, next = 0;
+    for (; next < live_keys; ++next) table.insert("k" + to_string(next), 1);
+    ResizableArray<string> misses;
+    for (size_t i = 0; i < live_keys; ++i) misses.push_back("m" + to_string(i));
+    for (size_t r = 0; r <= rounds; ++r) {
+        if (r > 0) {
+            for (size_t i = next - live_keys; i < next - live_keys + batch; ++i) table.erase("k" + to_string(i));
+            for (size_t end = next + batch; next < end; ++next) table.insert("k" + to_string(next), 1);
+        }
+        if (r != 0 && r != rounds && (r & (r - 1)) != 0) continue;  // report powers of two
+        ResizableArray<string> live;
+        for (size_t i = next - live_keys; i < next; ++i) live.push_back("k" + to_string(i));
+        assert(table.size() == live_keys);
+        cout << name << " round " << r << ": hit " << lookup_ns(table, live, true) << " ns, miss "
+             << lookup_ns(table, misses, false) << " ns/lookup";
+        if constexpr (is_same<Table, ProbingHash<string,int>>::value) {
+            cout << ", " << table.stats().tombstones << " tombstones in " << table.capacity() << " slots";
+        }
+        cout << "\n";
+    }
+}
+
+void delete_churn(size_t live_keys, size_t rounds) {
+    cout << "=== Insert/erase churn (" << live_keys << " live keys, " << rounds << " rounds) ===\n";
+    ProbingHash<string,int> probe(live_keys * 2, 0.7);
+    churn_rounds("linear probing", probe, live_keys, rounds);
+    SwissHash<string,int> swiss(live_keys * 2);
+    churn_rounds("swiss", swiss, live_keys, rounds);
+    ChainingHash<string,int> chain(live_keys);
+    churn_rounds("chaining", chain, live_keys, rounds);
+}
+
+// resident set figures from /proc (Linux); writing 5 to clear_refs resets
+// the peak so each input path gets its own high-water mark
+size_t status_kb(const string& field) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, field.size(), field) == 0) return strtoull(line.c_str() + field.size(), nullptr, 10);
+    }
+    return 0;
+}
+
+void reset_peak_rss() {
+    ofstream clear("/proc/self/clear_refs");
+    clear << "5";
+}
+
+// the original main(): whole file into a string, body substr, lowercase
+// copy, then a string per token before counting
+size_t count_by_copying(const string& path) {
+    ifstream in(path);
+    string full_text((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    string body(gutenberg_body(full_text));
+    for (size_t i = 0; i < body.size(); ++i) body[i] = tolower(body[i]);
+    ResizableArray<string> tokens;
+    tokenize(body, tokens);
+    WordCounter counter;
+    counter.add_all(tokens);
+    return counter.unique_words();
+}
+
+size_t count_mapped(const string& path) {
+    MappedFile file(path);
+    WordCounter counter;
+    for_each_token(file, gutenberg_body(file), [&](string_view w) { counter.add(w); });
+    return counter.unique_words();
+}
+
+size_t count_streamed(const string& path) {
+    ifstream in(path, ios::binary);
+    TextStream stream(in);
+    WordCounter counter;
+    stream.run([&](string_view w, int) { counter.add(w); });
+    return counter.unique_words();
+}
+
+void input_path_memory(const string& source, size_t corpus_mb) {
+    cout << "=== Input path: copy vs mmap vs chunked stream (" << corpus_mb << " MB file) ===\n";
+    const string path = "bench_corpus.tmp";
+    {
+        ofstream out(path, ios::binary);
+        for (size_t written = 0; written < corpus_mb * 1024 * 1024; written += source.size() + 1) {
+            out << source << ' ';
+        }
+    }
+
+    const char* names[] = { "read + copy", "mmap + views", "1 MB chunks" };
+    size_t (*paths[])(const string&) = { count_by_copying, count_mapped, count_streamed };
+    size_t unique[3];
+    for (int p = 0; p < 3; ++p) {
+        reset_peak_rss();
+        size_t base_kb = status_kb("VmRSS:");
+        auto start = high_resolution_clock::now();
+        unique[p] = paths[p](path);
+        auto end = high_resolution_clock::now();
+        size_t peak_kb = status_kb("VmHWM:");
+        cout << names[p] << ": " << duration_cast<nanoseconds>(end - start).count() << " ns, "
+             << unique[p] << " unique, peak RSS +" << (peak_kb > base_kb ? peak_kb - base_kb : 0) << " KB\n";
+    }
+    assert(unique[0] == unique[1] && unique[1] == unique[2]);
+    remove(path.c_str());
+}
+
+// The stream only sees a chunk at a time; its section numbers have to
+// land on the same headings find_sections() finds in the whole body, at
+// chunk sizes down to ones that cut lines in two. Each stream section is
+// the find_sections() range plus its heading line.
+void stream_sections(const string& source) {
+    string_view body = gutenberg_body(source);
+    ResizableArray<Section> found = find_sections(body);
+    ResizableArray<size_t> expected;
+    for (size_t s = 0; s < found.size(); ++s) {
+        size_t n = 0;
+        auto count = [&](string_view) { n++; };
+        for_each_token(body.substr(found[s].begin, found[s].end - found[s].begin), count);
+        for_each_token(found[s].title, count);
+        expected.push_back(n);
+    }
+    cout << "=== Stream sections vs find_sections (" << found.size() << " sections) ===\n";
+    for (size_t chunk : { size_t(64), size_t(4096), size_t(1) << 20 }) {
+        istringstream in(source);
+        TextStream stream(in, chunk);
+        vector<size_t> got(found.size(), 0);
+        StreamStats stats = stream.run([&](string_view, int section) {
+            assert(static_cast<size_t>(section) < got.size());
+            got[section]++;
+        });
+        assert(stats.sections + 1 == found.size());
+        for (size_t s = 0; s < found.size(); ++s) assert(got[s] == expected[s]);
+        cout << chunk << " B chunks: " << stats.sections << " headings, match\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <input_file> [corpus sizes in KB...]" << endl;
+        return 1;
+    }
+    ifstream infile(argv[1]);
+    if (!infile) {
+        cerr << "Error opening files";
+        return 1;
+    }
+    string source((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
+
+    // 100 KB up to 1 GB by default; pass e.g. 4194304 for a 4 GB corpus
+    ResizableArray<size_t> sizes_kb;
+    if (argc > 2) {
+        for (int i = 2; i < argc; ++i) sizes_kb.push_back(strtoull(argv[i], nullptr, 10));
+    } else {
+        for (size_t kb = 100; kb <= 1024 * 1024; kb *= 10) sizes_kb.push_back(kb);
+    }
+
+    // the linear scan is quadratic in the vocabulary, only run it on small inputs
+    word_count_scaling(source, sizes_kb, 1024);
+    growth_latency(1000000);
+    input_path_memory(source, 128);
+    stream_sections(source);
+    tokenizer_throughput(source, 64);
+    parallel_scaling(source, 64);
+    parallel_interning(source, 64);
+    section_scaling(source, 64);
+    shared_table_contention(source, 16);
+    substring_search(source, 64);
+    interned_tokens(source, 64);
+    array_growth(source, 64);
+    delete_churn(100000, 64);
+    return 0;
+}
@@ -2,43 +2,69 @@
 #define CHAINING_HASH_H
 
 #include "HashTable.h"
+#include "HashFunctions.h"
+#include "TableStats.h"
 #include <list>
 #include <vector>
 #include <cstdlib>  // for size_t
 #include <cstring>
+#include <algorithm>
+#include <memory>
 
 using namespace std;
 
-template<typename Key, typename Value>
+// Nodes and the bucket array come from Alloc, rebound as needed.
+template<typename Key, typename Value, typename Hasher = WyHash,
+         typename Alloc = std::allocator<pair<Key,Value>>>
 class ChainingHash : public HashTable<Key,Value> {
 public:
-    typedef size_t (*HashFunc)(const Key&, size_t);
-    explicit ChainingHash(size_t table_size, HashFunc hf = nullptr)
-      : hsize(table_size), table(table_size), count(0) {
-        hash_func = hf ? hf : default_string_hash;
-    }
+    explicit ChainingHash(size_t table_size, const Hasher& hf = Hasher(), const Alloc& alloc = Alloc())
+      : hsize(table_size), table(table_size, Chain(alloc), BucketAlloc(alloc)), count(0), hasher(hf) {}
     ~ChainingHash() override = default;
 
     void insert(const Key& key, const Value& value) override {
-        size_t idx = hash_func(key, hsize);
-        // 1) look for an existing key in the chain
-        for (auto& kv : table[idx]) {
-            if (kv.first == key) {
-                kv.second = value;    // overwrite existing count
-                return;
-            }
-        }
-        // 2) not found → insert new
-        table[idx].push_back(make_pair(key, value));
-        count++;
+        find_or_insert(key, value) = value;    // overwrite existing count
+    }
+
+    Value& find_or_insert(const Key& key, const Value& initial) override {
+        return find_or_insert_at(bucket_index(hasher(key), hsize), key, initial);
     }
-    
 
     bool find(const Key& key, Value& value_out) const override {
-        size_t idx = hash_func(key, hsize);
-        for (auto& kv : table[idx]) {
-            if (kv.first == key) {
-                value_out = kv.second;
+        return find_at(bucket_index(hasher(key), hsize), key, value_out);
+    }
+
+    // Batched insert / increment / find; see HASH_BATCH. Without deltas
+    // every key is incremented by one. find_batch returns the hits, and
+    // sets found[i] if found isn't null; misses leave values_out[i] alone.
+    void insert_batch(const Key* keys, const Value* values, size_t n) {
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            find_or_insert_at(bucket_index(h, hsize), keys[i], values[i]) = values[i];
+        });
+    }
+
+    void increment_batch(const Key* keys, size_t n, const Value* deltas = nullptr) {
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            find_or_insert_at(bucket_index(h, hsize), keys[i], Value()) += deltas ? deltas[i] : Value(1);
+        });
+    }
+
+    size_t find_batch(const Key* keys, size_t n, Value* values_out, bool* found = nullptr) const {
+        size_t hits = 0;
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            bool hit = find_at(bucket_index(h, hsize), keys[i], values_out[i]);
+            if (found) found[i] = hit;
+            hits += hit;
+        });
+        return hits;
+    }
+
+    bool erase(const Key& key) override {
+        auto& chain = table[bucket_index(hasher(key), hsize)];
+        for (auto it = chain.begin(); it != chain.end(); ++it) {
+            if (it->first == key) {
+                chain.erase(it);
+                count--;
                 return true;
             }
         }
@@ -51,24 +77,100 @@ public:
         return static_cast<double>(count) / hsize;
     }
 
-    void set_hash_function(HashFunc hf) {
-        assert(hf != nullptr);
-        hash_func = hf;
+    size_t bucket_count() const { return hsize; }
+
+    // fn(key, value) for every entry, bucket by bucket
+    template<typename Fn>
+    void for_each(Fn fn) const {
+        for (auto& chain : table) {
+            for (auto& kv : chain) fn(kv.first, kv.second);
+        }
+    }
+
+    size_t max_chain_length() const {
+        size_t longest = 0;
+        for (auto& chain : table) longest = max(longest, chain.size());
+        return longest;
+    }
+
+    // keys that landed in a bucket somebody else already had
+    size_t collisions() const {
+        size_t used = 0;
+        for (auto& chain : table) used += !chain.empty();
+        return count - used;
+    }
+
+    TableStats stats() const {
+        TableStats s;
+        s.layout = "chaining";
+        s.size = count;
+        s.slots = hsize;
+        s.histogram.assign(max_chain_length() + 1, 0);
+        for (auto& chain : table) s.histogram[chain.size()]++;
+        s.tombstones = 0;
+        // a list node is the pair plus its two links
+        s.bytes = sizeof(*this) + table.capacity() * sizeof(table[0]) +
+                  count * (sizeof(pair<Key,Value>) + 2 * sizeof(void*));
+        add_lookup_counts(s, lookups);
+        return s;
     }
 
 private:
+    typedef list<pair<Key,Value>, Alloc> Chain;
+    typedef typename allocator_traits<Alloc>::template rebind_alloc<Chain> BucketAlloc;
+
     size_t hsize;
-    vector<list<pair<Key,Value>>> table;
+    vector<Chain, BucketAlloc> table;
     size_t count;
-    HashFunc hash_func;
+    Hasher hasher;
+    mutable LookupCounters lookups;
+
+    // the work of find_or_insert and find once the key's bucket is known
+    Value& find_or_insert_at(size_t idx, const Key& key, const Value& initial) {
+        size_t probes = 0;
+        // 1) look for an existing key in the chain
+        for (auto& kv : table[idx]) {
+            probes++;
+            if (kv.first == key) {
+                lookups.hit(probes);
+                return kv.second;
+            }
+        }
+        lookups.miss(probes);
+        // 2) not found → insert new
+        table[idx].push_back(make_pair(key, initial));
+        count++;
+        return table[idx].back().second;
+    }
 
-    // Horners rule
-    static size_t default_string_hash(const string& s, size_t mod) {
-        size_t h = 0;
-        for (char c : s) {
-            h = (h * 31 + static_cast<unsigned char>(c)) % mod;
+    bool find_at(size_t idx, const Key& key, Value& value_out) const {
+        size_t probes = 0;
+        for (auto& kv : table[idx]) {
+            probes++;
+            if (kv.first == key) {
+                lookups.hit(probes);
+                value_out = kv.second;
+                return true;
+            }
         }
-        return h;
+        lookups.miss(probes);
+        return false;
+    }
+
+    // Hashes a group and prefetches its buckets, then the first node of
+    // each chain: the node's address is in the bucket, so that's a second
+    // round, by which time the first group of lines is on its way.
+    auto prefetcher() const {
+        return [this](const Key* keys, size_t m, uint64_t* h) {
+            for (size_t i = 0; i < m; ++i) {
+                h[i] = hasher(keys[i]);
+                __builtin_prefetch(&table[bucket_index(h[i], hsize)]);
+            }
+            for (size_t i = 0; i < m; ++i) {
+                const auto& chain = table[bucket_index(h[i], hsize)];
+                if (!chain.empty()) __builtin_prefetch(&chain.front());
+            }
+        };
     }
 };
 
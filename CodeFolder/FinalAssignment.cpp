@@ -1,101 +1,209 @@
 #include "ChainingHash.h"
 #include "ProbingHash.h"
+#include "PoolChainingHash.h"
+#include "SwissHash.h"
 #include "FinalAssignment.h"
+#include "TextUtils.h"
+#include "WordCounter.h"
+#include "MappedFile.h"
+#include "SimdText.h"
+#include "ParallelCounter.h"
+#include "TopK.h"
+#include "InvertedIndex.h"
+#include "SubstringSearch.h"
+#include "Snapshot.h"
+#include "StringPool.h"
+#include "BenchHarness.h"
+#include "Sections.h"
 #include <iostream>
+#include <iomanip>
+#include <memory>
 #include <fstream>
 #include <string>
 #include <cctype>
 #include <chrono>
 #include <cstdlib>
 #include <cassert>
+#include <thread>
 
 using namespace std;
 using namespace chrono;
 
-// Function to detect section headers like I II
-bool is_section_header(const string& word) {
-    if (word.empty() || word.back() != '.') return false;
-    string roman = word.substr(0, word.size() - 1);
-    for (char c : roman) {
-        if (c != 'I' && c != 'V' && c != 'X') return false;
-    }
-    return true;
-}
+// std::allocator that also counts its allocations into *count, for the
+// storage experiment to hand to the tables it measures
+template<typename T>
+struct CountingAllocator {
+    typedef T value_type;
 
-string clean_token(const string& token) {
-    string temp;
-    for (char c : token) {
-        if (isalnum(c)) temp += tolower(c);
+    explicit CountingAllocator(size_t& count) : count(&count) {}
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : count(other.count) {}
+
+    T* allocate(size_t n) {
+        ++*count;
+        return allocator<T>().allocate(n);
     }
-    return temp;
+    void deallocate(T* p, size_t n) { allocator<T>().deallocate(p, n); }
+
+    size_t* count;
+};
+
+template<typename T, typename U>
+bool operator==(const CountingAllocator<T>& a, const CountingAllocator<U>& b) { return a.count == b.count; }
+template<typename T, typename U>
+bool operator!=(const CountingAllocator<T>& a, const CountingAllocator<U>& b) { return a.count != b.count; }
+
+// average ns per lookup of keys that are all in the table (hit) or all
+// not in it; 0 with no keys (a text with no tokens)
+long long average_lookup_time(const HashTable<string,int>& table, const ResizableArray<string>& keys, bool hit) {
+    if (keys.empty()) return 0;
+    int v;
+    size_t hits = 0;
+    auto start = high_resolution_clock::now();
+    for (size_t j = 0; j < keys.size(); ++j) hits += table.find(keys[j], v);
+    auto end = high_resolution_clock::now();
+    assert(hits == (hit ? keys.size() : 0));
+    return duration_cast<nanoseconds>(end - start).count() / (long long)keys.size();
 }
 
-// simple selection sort descending 
-template<typename T>
-void sort_freq_desc(ResizableArray<pair<T,int>>& arr) {
-    for (size_t i = 0; i + 1 < arr.size(); ++i) {
-        size_t maxidx = i;
-        for (size_t j = i + 1; j < arr.size(); ++j) {
-            if (arr[j].second > arr[maxidx].second) maxidx = j;
-        }
-        if (maxidx != i) swap(arr[i], arr[maxidx]);
-    }
+// average slots a lookup of each key looks at; 0 with no keys
+double average_probes(const ProbingHash<string,int>& table, const ResizableArray<string>& keys) {
+    if (keys.empty()) return 0.0;
+    size_t probes = 0;
+    for (size_t j = 0; j < keys.size(); ++j) probes += table.probes_for(keys[j]);
+    return static_cast<double>(probes) / keys.size();
 }
 
-// simple selection sort ascending
-template<typename T>
-void sort_freq_asc(ResizableArray<pair<T,int>>& arr) {
-    for (size_t i = 0; i + 1 < arr.size(); ++i) {
-        size_t minidx = i;
-        for (size_t j = i + 1; j < arr.size(); ++j) {
-            if (arr[j].second < arr[minidx].second) minidx = j;
-        }
-        if (minidx != i) swap(arr[i], arr[minidx]);
-    }
+// filler keys can't collide with tokens, which are lowercase alphanumerics
+void prefill(HashTable<string,int>& table, size_t n) {
+    for (size_t i = 0; i < n; ++i) table.insert("#" + to_string(i), 0);
 }
 
-ResizableArray<size_t> rabin_karp(const ResizableArray<string>& tokens, const string& key) {
-    ResizableArray<size_t> positions;
-    size_t key_hash = 0;
-    for (char c : key) key_hash = key_hash * 31 + (unsigned char)c;
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        size_t h = 0;
-        for (char c : tokens[i]) h = h * 31 + (unsigned char)c;
-        if (h == key_hash && tokens[i] == key) positions.push_back(i + 1);
-    }
-    return positions;
+// counting time, longest chain and bucket collisions for one hasher
+template<typename Hasher>
+void hash_shootout_row(ostream& out, const char* name, const ResizableArray<string>& tokens, const BenchConfig& cfg) {
+    BenchStats stats = measure(cfg, [&] { ChainingHash<string,int,Hasher> t(20011); return time_count(t, tokens); });
+    ChainingHash<string,int,Hasher> chain(20011);
+    for (size_t j = 0; j < tokens.size(); ++j) chain.increment(tokens[j]);
+    out << name << " → " << format_stats(stats, tokens.size())
+        << ", max chain " << chain.max_chain_length()
+        << ", collisions " << chain.collisions() << " of " << chain.size() << " keys\n";
 }
 
-size_t simple_mod_hash(const string& s, size_t hsize) {
-    size_t sum = 0;
-    for (char c : s) sum += static_cast<unsigned char>(c);
-    return sum % hsize;
+// One probe scheme with `slots` slots topped up with `fill` filler keys:
+// counting time, then probes and ns per lookup of the tokens once they're
+// all in, and of keys that aren't. A scheme that ran out of room in reach
+// before the load factor grew, and says so.
+void probe_scheme_row(ostream& out, ProbeScheme scheme, size_t slots, size_t fill, const ResizableArray<string>& tokens,
+                      const ResizableArray<string>& misses, const BenchConfig& cfg) {
+    auto make = [&] { ProbingHash<string,int> t(slots, 0.96, GROW_REHASH, scheme); prefill(t, fill); return t; };
+    BenchStats stats = measure(cfg, [&] { auto t = make(); return time_count(t, tokens); });
+    ProbingHash<string,int> table = make();
+    for (size_t j = 0; j < tokens.size(); ++j) table.increment(tokens[j]);
+    out << "  " << probe_scheme_name(scheme) << " → count " << static_cast<long long>(stats.median_ns) << " ns"
+        << "; hit " << average_probes(table, tokens) << " probes, " << average_lookup_time(table, tokens, true) << " ns"
+        << "; miss " << average_probes(table, misses) << " probes, " << average_lookup_time(table, misses, false) << " ns";
+    if (table.capacity() != slots) out << " (grew to " << table.capacity() << " slots)";
+    out << "\n";
 }
 
-void tokenize(const string& text, ResizableArray<string>& tokens) {
-    string token;
-    for (char c : text) {
-        if (isalnum(c)) {
-            token += tolower(c);
-        } else if (!token.empty()) {
-            tokens.push_back(token);
-            token.clear();
-        }
-    }
-    if (!token.empty()) tokens.push_back(token);
+// build a table from the tokens, then look up `keys` in a scattered order;
+// with enough keys the chains no longer fit in cache and every pointer
+// chase shows up in the lookup time. Table takes a CountingAllocator, which
+// counts what the table itself allocates (not the keys' own strings).
+// keys must not be empty.
+template<typename Table>
+void time_chain_storage(ostream& out, const char* name, const ResizableArray<string>& tokens, const ResizableArray<string>& keys) {
+    assert(!keys.empty());
+    typedef CountingAllocator<pair<string,int>> Counting;
+    size_t count_allocs = 0;
+    auto start = high_resolution_clock::now();
+    Table counted(20011, WyHash(), Counting(count_allocs));
+    for (size_t j = 0; j < tokens.size(); ++j) counted.increment(tokens[j]);
+    auto end = high_resolution_clock::now();
+    long long count_time = duration_cast<nanoseconds>(end - start).count();
+
+    size_t big_allocs = 0;
+    Table big(keys.size() / 2 + 1, WyHash(), Counting(big_allocs));
+    big_allocs = 0;  // the bucket array isn't part of the build
+    start = high_resolution_clock::now();
+    for (size_t j = 0; j < keys.size(); ++j) big.insert(keys[j], static_cast<int>(j));
+    end = high_resolution_clock::now();
+    long long build_time = duration_cast<nanoseconds>(end - start).count();
+
+    int v;
+    size_t hits = 0;
+    start = high_resolution_clock::now();
+    for (size_t j = 0; j < keys.size(); ++j) hits += big.find(keys[(j * 7919) % keys.size()], v);
+    end = high_resolution_clock::now();
+    assert(hits == keys.size());
+
+    out << name << " → count " << count_time << " ns, " << count_allocs << " allocations"
+        << "; " << keys.size() << " keys: build " << build_time << " ns, " << big_allocs << " allocations, "
+        << duration_cast<nanoseconds>(end - start).count() / (long long)keys.size() << " ns/lookup\n";
 }
-//sentence counter
-size_t count_sentences(const string& text) {
-    size_t count = 0;
-    for (char c : text) {
-        if (c == '.' || c == '!' || c == '?') count++;
-    }
-    return count;
+
+// One key at a time against the batched calls: building a table far
+// bigger than the cache from keys and looking them all up again in the
+// scattered order, then counting the text into a table that does fit.
+// make(n) gives an empty table sized for n keys; keys must not be empty.
+template<typename Make>
+void time_batching(ostream& out, const char* name, Make make, const ResizableArray<string>& keys,
+                   const ResizableArray<string>& scattered, const ResizableArray<string>& tokens, const BenchConfig& cfg) {
+    assert(!keys.empty());
+    ResizableArray<int> values;
+    for (size_t j = 0; j < keys.size(); ++j) values.push_back(static_cast<int>(j));
+    auto timed = [](auto fn) {
+        auto start = high_resolution_clock::now();
+        fn();
+        return duration_cast<nanoseconds>(high_resolution_clock::now() - start).count();
+    };
+    BenchStats build = measure(cfg, [&] {
+        auto t = make(keys.size());
+        return timed([&] { for (size_t j = 0; j < keys.size(); ++j) t.insert(keys[j], values[j]); });
+    });
+    BenchStats build_batch = measure(cfg, [&] {
+        auto t = make(keys.size());
+        return timed([&] { t.insert_batch(keys.begin(), values.begin(), keys.size()); });
+    });
+
+    auto big = make(keys.size());
+    big.insert_batch(keys.begin(), values.begin(), keys.size());
+    vector<int> found(scattered.size());
+    BenchStats find = measure(cfg, [&] {
+        size_t hits = 0;
+        long long ns = timed([&] { for (size_t j = 0; j < scattered.size(); ++j) hits += big.find(scattered[j], found[j]); });
+        assert(hits == scattered.size());
+        return ns;
+    });
+    BenchStats find_batch = measure(cfg, [&] {
+        size_t hits = 0;
+        long long ns = timed([&] { hits = big.find_batch(scattered.begin(), scattered.size(), found.data()); });
+        assert(hits == scattered.size());
+        return ns;
+    });
+
+    BenchStats count = measure(cfg, [&] { auto t = make(20011); return time_count(t, tokens); });
+    BenchStats count_batch = measure(cfg, [&] { auto t = make(20011); return time_count_batched(t, tokens); });
+
+    long long n = static_cast<long long>(keys.size());
+    out << name << ", " << keys.size() << " keys → insert " << static_cast<long long>(build.median_ns) / n
+        << " ns/key, insert_batch " << static_cast<long long>(build_batch.median_ns) / n << " ns/key"
+        << "; find " << static_cast<long long>(find.median_ns) / n << " ns/lookup, find_batch "
+        << static_cast<long long>(find_batch.median_ns) / n << " ns/lookup\n";
+    out << "    text → increment " << format_stats(count, tokens.size())
+        << "\n    increment_batch " << format_stats(count_batch, tokens.size()) << "\n";
 }
 
 // tests
-void run_experiments(const ResizableArray<string>& tokens) {
-    const int NUM_RUNS = 10;
+void run_experiments(ostream& out, const StringPool& words, const ResizableArray<uint32_t>& ids) {
+    // the tables under test are keyed by string, so spell the token stream
+    // out once here rather than inside the timed loops
+    ResizableArray<string> tokens;
+    for (size_t j = 0; j < ids.size(); ++j) tokens.push_back(string(words.view(ids[j])));
+
+    // a couple of untimed runs first so the allocator and caches are warm
+    const BenchConfig cfg = {2, 10};
     ResizableArray<double> load_factors;
     load_factors.push_back(0.5);
     load_factors.push_back(0.7);
@@ -105,85 +213,115 @@ void run_experiments(const ResizableArray<string>& tokens) {
     table_sizes.push_back(10007);
     table_sizes.push_back(20011);
 
-    cout << "\n=== Experiment 1: Linear Probing with Varying Load Factors ===\n";
+    out << "\n=== Experiment 1: Linear Probing with Varying Load Factors ===\n";
     for (size_t i = 0; i < load_factors.size(); ++i) {
         double lf = load_factors[i];
-        long long total_time = 0;
-        for (int run = 0; run < NUM_RUNS; ++run) {
-            ProbingHash<string, int> probe(20011, lf);
-            auto start = high_resolution_clock::now();
-            for (size_t j = 0; j < tokens.size(); ++j) {
-                int v;
-                string w = tokens[j];
-                probe.find(w, v) ? probe.insert(w, v + 1) : probe.insert(w, 1);
-            }
-            auto end = high_resolution_clock::now();
-            total_time += duration_cast<nanoseconds>(end - start).count();
-        }
-        cout << "Load factor: " << lf
-             << " → Average Time (" << NUM_RUNS << " runs): "
-             << (total_time / NUM_RUNS) << " ns\n";
+        BenchStats stats = measure(cfg, [&] { ProbingHash<string,int> t(20011, lf); return time_count(t, tokens); });
+        out << "Load factor: " << lf << " → " << format_stats(stats, tokens.size()) << "\n";
     }
 
-    cout << "\n=== Experiment 2: Chaining with Varying Table Sizes ===\n";
+    out << "\n=== Experiment 2: Chaining with Varying Table Sizes ===\n";
     for (size_t i = 0; i < table_sizes.size(); ++i) {
         size_t sz = table_sizes[i];
-        long long total_time = 0;
-        for (int run = 0; run < NUM_RUNS; ++run) {
-            ChainingHash<string, int> chain(sz);
-            auto start = high_resolution_clock::now();
-            for (size_t j = 0; j < tokens.size(); ++j) {
-                int v;
-                string w = tokens[j];
-                chain.find(w, v) ? chain.insert(w, v + 1) : chain.insert(w, 1);
-            }
-            auto end = high_resolution_clock::now();
-            total_time += duration_cast<nanoseconds>(end - start).count();
+        BenchStats stats = measure(cfg, [&] { ChainingHash<string,int> t(sz); return time_count(t, tokens); });
+        out << "Table size: " << sz << " → " << format_stats(stats, tokens.size()) << "\n";
+    }
+
+    out << "\n=== Experiment 3: Comparing Hash Functions (Chaining) ===\n";
+    hash_shootout_row<HornerHash>(out, "Horner's", tokens, cfg);
+    hash_shootout_row<SimpleModHash>(out, "Simple mod hash", tokens, cfg);
+    hash_shootout_row<FNV1aHash>(out, "FNV-1a", tokens, cfg);
+    hash_shootout_row<WyHash>(out, "wyhash-style", tokens, cfg);
+
+    WordCounter vocab;
+    vocab.add_all(tokens);
+    ResizableArray<string> misses;
+    for (size_t j = 0; j < tokens.size(); ++j) misses.push_back("@" + tokens[j]);
+
+    out << "\n=== Experiment 4: Collision Handling (Probe Schemes by Load Factor) ===\n";
+    {
+        // a prime slot count, so double hashing's steps reach every slot;
+        // probes are slots a lookup looks at
+        const size_t PRIME_SLOTS = 16381;
+        const ProbeScheme schemes[] = { PROBE_LINEAR, PROBE_QUADRATIC, PROBE_DOUBLE, PROBE_HOPSCOTCH, PROBE_CUCKOO };
+        for (double lf : { 0.5, 0.6, 0.7, 0.8, 0.9, 0.95 }) {
+            size_t target = static_cast<size_t>(lf * PRIME_SLOTS);
+            size_t fill = target > vocab.unique_words() ? target - vocab.unique_words() : 0;
+            out << "Load factor: " << lf << "\n";
+            for (ProbeScheme scheme : schemes) probe_scheme_row(out, scheme, PRIME_SLOTS, fill, tokens, misses, cfg);
+        }
+    }
+
+    out << "\n=== Experiment 5: Linear Probing vs Swiss Control Bytes ===\n";
+    // both tables get the same slot count and are topped up with filler keys
+    // so the vocabulary leaves them at exactly the target load factor
+    const size_t SLOTS = 16384;
+    for (size_t i = 0; i < load_factors.size(); ++i) {
+        double lf = load_factors[i];
+        size_t target = static_cast<size_t>(lf * SLOTS);
+        size_t fill = target > vocab.unique_words() ? target - vocab.unique_words() : 0;
+        auto make_probe = [&] { ProbingHash<string,int> t(SLOTS, 0.95, GROW_NONE); prefill(t, fill); return t; };
+        auto make_swiss = [&] { SwissHash<string,int> t(SLOTS, 0.95); prefill(t, fill); return t; };
+
+        BenchStats probe_stats = measure(cfg, [&] { auto t = make_probe(); return time_count(t, tokens); });
+        BenchStats swiss_stats = measure(cfg, [&] { auto t = make_swiss(); return time_count(t, tokens); });
+        ProbingHash<string,int> probe = make_probe();
+        SwissHash<string,int> swiss = make_swiss();
+        for (size_t k = 0; k < vocab.counts().size(); ++k) {
+            probe.insert(vocab.counts()[k].first, vocab.counts()[k].second);
+            swiss.insert(vocab.counts()[k].first, vocab.counts()[k].second);
         }
-        cout << "Table size: " << sz
-             << " → Average Time (" << NUM_RUNS << " runs): "
-             << (total_time / NUM_RUNS) << " ns\n";
+
+        out << "Load factor: " << probe.load_factor()
+            << " → Linear probing " << static_cast<long long>(probe_stats.median_ns) << " ns (miss " << average_lookup_time(probe, misses, false) << " ns/lookup)"
+            << ", Swiss " << static_cast<long long>(swiss_stats.median_ns) << " ns (miss " << average_lookup_time(swiss, misses, false) << " ns/lookup)\n";
     }
 
-    cout << "\n=== Experiment 3: Comparing Hash Functions (Chaining) ===\n";
-    // Horners Rule
+    out << "\n=== Experiment 6: find-then-insert vs single-probe increment ===\n";
     {
-        long long total_time = 0;
-        for (int run = 0; run < NUM_RUNS; ++run) {
-            ChainingHash<string, int> chain(20011);
-            auto start = high_resolution_clock::now();
-            for (size_t j = 0; j < tokens.size(); ++j) {
-                int v;
-                string w = tokens[j];
-                chain.find(w, v) ? chain.insert(w, v + 1) : chain.insert(w, 1);
-            }
-            auto end = high_resolution_clock::now();
-            total_time += duration_cast<nanoseconds>(end - start).count();
+        const char* names[] = { "Chaining", "Linear probing", "Swiss" };
+        BenchStats before[3], after[3];
+        for (int p = 0; p < 2; ++p) {
+            bool single_probe = p == 1;
+            BenchStats* results = single_probe ? after : before;
+            results[0] = measure(cfg, [&] { ChainingHash<string,int> t(20011); return time_count(t, tokens, single_probe); });
+            results[1] = measure(cfg, [&] { ProbingHash<string,int> t(20011, 0.7); return time_count(t, tokens, single_probe); });
+            results[2] = measure(cfg, [&] { SwissHash<string,int> t(20011); return time_count(t, tokens, single_probe); });
+        }
+        for (int t = 0; t < 3; ++t) {
+            out << names[t] << " → find+insert " << format_stats(before[t], tokens.size())
+                << "\n    increment " << format_stats(after[t], tokens.size()) << "\n";
         }
-        cout << "Horner's → Average Time (" << NUM_RUNS << " runs): "
-             << (total_time / NUM_RUNS) << " ns\n";
     }
-    // Simple Mod Hash
+
+    out << "\n=== Experiment 7: Chaining Storage (std::list vs node pool) ===\n";
     {
-        long long total_time = 0;
-        for (int run = 0; run < NUM_RUNS; ++run) {
-            ChainingHash<string, int> chain(20011, simple_mod_hash);
-            auto start = high_resolution_clock::now();
-            for (size_t j = 0; j < tokens.size(); ++j) {
-                int v;
-                string w = tokens[j];
-                chain.find(w, v) ? chain.insert(w, v + 1) : chain.insert(w, 1);
-            }
-            auto end = high_resolution_clock::now();
-            total_time += duration_cast<nanoseconds>(end - start).count();
+        // 7919 is prime and doesn't divide the key count, so the lookups
+        // visit every key in a cache-hostile order
+        ResizableArray<string> keys;
+        for (size_t j = 0; j < 500000; ++j) keys.push_back("key" + to_string(j));
+        // the scattered order and ns/lookup both divide by the key count
+        if (!keys.empty()) {
+            typedef CountingAllocator<pair<string,int>> Counting;
+            time_chain_storage<ChainingHash<string,int,WyHash,Counting>>(out, "std::list chains", tokens, keys);
+            time_chain_storage<PoolChainingHash<string,int,WyHash,Counting>>(out, "Node pool chains", tokens, keys);
         }
-        cout << "Simple mod hash → Average Time (" << NUM_RUNS << " runs): "
-             << (total_time / NUM_RUNS) << " ns\n";
     }
 
-    cout << "\n=== Experiment 4: Collision Handling (Linear Probing) ===\n";
-    cout << "Collision resolution uses linear probing: if a collision occurs, probe the next slot using (i + 1) % hsize.\n";
-    cout << "This method is based on open addressing, as discussed in class.\n";
+    out << "\n=== Experiment 8: Batched Insert and Lookup with Prefetching ===\n";
+    {
+        // the big builds are slow enough that a few runs will do
+        const BenchConfig few = {1, 3};
+        ResizableArray<string> keys, scattered;
+        for (size_t j = 0; j < 500000; ++j) keys.push_back("key" + to_string(j));
+        // the scattered order and the per-key times divide by the key count
+        if (!keys.empty()) {
+            for (size_t j = 0; j < keys.size(); ++j) scattered.push_back(keys[(j * 7919) % keys.size()]);
+            time_batching(out, "Chaining", [](size_t n) { return ChainingHash<string,int>(n); }, keys, scattered, tokens, few);
+            time_batching(out, "Linear probing", [](size_t n) { return ProbingHash<string,int>(n * 2, 0.7); },
+                          keys, scattered, tokens, few);
+        }
+    }
 }
 
 void menu() {
@@ -193,124 +331,406 @@ void menu() {
          << "3. Search up to 8 keys in 'Engineer’s Thumb'" << endl
          << "4. Count sentences" << endl
          << "5. Run experiments" << endl
+         << "6. Search up to 8 substrings in the raw text" << endl
+         << "7. Hash table statistics" << endl
+         << "8. Top words in a range of sections" << endl
+         << "9. Compare two ranges of sections" << endl
          << "0. Exit" << endl
          << "Choice: ";
 }
 
-int main(int argc, char* argv[]) {
-    if (argc != 3) {
-        cerr << "Usage: " << argv[0] << " <input_file> <output_file>";
-        return 1;
-    }
-    ifstream infile(argv[1]);
-    ofstream outfile(argv[2]);
-    if (!infile || !outfile) {
-        cerr << "Error opening files";
-        return 1;
+const size_t TABLE_SIZE = 20011;
+const double MAX_LOAD = 0.7;
+
+// Each query below writes one self-contained report to out. The menu gives
+// every report a freshly truncated output file; batch mode writes all the
+// requested reports to the same stream one after another.
+
+// keys separated by '@@@'
+ResizableArray<string> split_keys(string line) {
+    ResizableArray<string> keys;
+    size_t pos = 0;
+    while ((pos = line.find("@@@")) != string::npos) {
+        keys.push_back(line.substr(0, pos));
+        line.erase(0, pos + 3);
     }
+    if (!line.empty()) keys.push_back(line);
+    return keys;
+}
 
-    // Read entire file into a string
-    string full_text((istreambuf_iterator<char>(infile)), istreambuf_iterator<char>());
-
-    // Extract Gutenberg body.. might help?
-    const string START_MARKER = "*** START OF THIS PROJECT GUTENBERG EBOOK A SCANDAL IN BOHEMIA ***";
-    const string END_MARKER   = "*** END OF THIS PROJECT GUTENBERG EBOOK A SCANDAL IN BOHEMIA ***";
-    size_t start = full_text.find(START_MARKER);
-    size_t end   = full_text.find(END_MARKER);
-    string body;
-    if (start != string::npos && end != string::npos && end > start) {
-        body = full_text.substr(start + START_MARKER.length(),
-                                end - (start + START_MARKER.length()));
-    } else {
-        body = full_text; // fallback to entire text
+// the k most frequent words, or the k rarest
+void write_top_words(ostream& out, const StringPool& words, const ResizableArray<pair<uint32_t,int>>& freq_list,
+                     size_t k, bool frequent) {
+    auto start = high_resolution_clock::now(); // Start timing
+    auto picked = frequent ? top_k_frequent(freq_list, k) : top_k_rare(freq_list, k);
+    auto end = high_resolution_clock::now(); // End timing
+    out << (frequent ? "Top " : "Bottom ") << k << " Words:\n";
+    for (size_t i = 0; i < picked.size(); ++i) {
+        out << words.view(picked[i].first) << ": " << picked[i].second << "\n";
     }
+    out << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+}
 
-    // Lowercase everything
-    for (size_t i = 0; i < body.size(); ++i) body[i] = tolower(body[i]);
+// a key with several words ("irene adler") is a phrase
+void write_key_search(ostream& out, const StringPool& words, const InvertedIndex& search_index, const string& line) {
+    ResizableArray<string> raw = split_keys(line);
+    ResizableArray<ResizableArray<string>> keys;
+    for (size_t k = 0; k < raw.size(); ++k) keys.push_back(key_words(raw[k]));
+    auto start = high_resolution_clock::now(); // Start timing
+    out << "Key Search Results:\n";
+    for (size_t k = 0; k < keys.size(); ++k) {
+        // a word the text never had can't be part of a match
+        ResizableArray<uint32_t> ids;
+        bool known = true;
+        for (size_t w = 0; w < keys[k].size(); ++w) {
+            uint32_t id;
+            if (words.lookup(keys[k][w], id)) ids.push_back(id);
+            else known = false;
+        }
+        auto positions = known ? search_index.phrase(ids) : ResizableArray<size_t>();
+        out << "Key '";
+        for (size_t w = 0; w < keys[k].size(); ++w) out << (w ? " " : "") << keys[k][w];
+        out << "' at positions: ";
+        for (size_t pidx = 0; pidx < positions.size(); ++pidx) {
+            out << positions[pidx] << " ";
+        }
+        out << "\n";
+    }
+    auto end = high_resolution_clock::now(); // End timing
+    out << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+}
 
-    // Tokenize text
-    ResizableArray<string> tokens;
-    tokenize(body, tokens);
+void write_sentence_count(ostream& out, size_t sentence_count, long long runtime_ns) {
+    out << "Sentence count: " << sentence_count << "\n";
+    out << "Runtime: " << runtime_ns << " ns\n"; // Use pre-measured runtime
+}
 
-    // Count sentences
-    auto start_sentence_count = high_resolution_clock::now(); // Start timing for sentence count
-    size_t sentence_count = count_sentences(body);
-    auto end_sentence_count = high_resolution_clock::now(); // End timing for sentence count
-    long long sentence_count_runtime_ns = duration_cast<nanoseconds>(end_sentence_count - start_sentence_count).count();
+// keys are taken as typed and matched without regard to ASCII case
+void write_substring_search(ostream& out, string_view body, const string& line) {
+    ResizableArray<string> keys = split_keys(line);
+    auto start = high_resolution_clock::now(); // Start timing
+    auto matches = rabin_karp_search(body, keys);
+    auto numbers = token_numbers(body, matches);
+    auto end = high_resolution_clock::now(); // End timing
+    out << "Substring Search Results:\n";
+    for (size_t k = 0; k < keys.size(); ++k) {
+        out << "Key '" << keys[k] << "' at byte offsets: ";
+        for (size_t m = 0; m < matches.size(); ++m) {
+            if (matches[m].pattern == k) out << matches[m].offset << " ";
+        }
+        out << "\nKey '" << keys[k] << "' at token positions: ";
+        for (size_t m = 0; m < matches.size(); ++m) {
+            if (matches[m].pattern == k) out << numbers[m] << " ";
+        }
+        out << "\n";
+    }
+    out << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+}
 
-    // Build frequency table
-    ResizableArray<pair<string,int>> freq_list;
+// the whole vocabulary as string keys, the way the experiments count it:
+// every word is looked up once more, and once with a prefix no token has,
+// for hit and miss probe counts; then the two section tables
+void write_hash_stats(ostream& out, const StringPool& words, const ResizableArray<uint32_t>& tokens,
+                      const ChainingHash<uint32_t,int,IdHash>& chain_table,
+                      const ProbingHash<uint32_t,int,IdHash>& probe_table) {
+    ChainingHash<string,int> text_chain(TABLE_SIZE);
+    ProbingHash<string,int> text_probe(TABLE_SIZE, MAX_LOAD);
     for (size_t i = 0; i < tokens.size(); ++i) {
-        const string& w = tokens[i];
-        bool found = false;
-        for (size_t j = 0; j < freq_list.size(); ++j) {
-            if (freq_list[j].first == w) {
-                freq_list[j].second++;
-                found = true;
-                break;
-            }
+        string w(words.view(tokens[i]));
+        text_chain.increment(w);
+        text_probe.increment(w);
+    }
+    int v;
+    for (uint32_t id = 0; id < words.size(); ++id) {
+        string w(words.view(id));
+        text_chain.find(w, v);
+        text_probe.find(w, v);
+        text_chain.find("@" + w, v);
+        text_probe.find("@" + w, v);
+        // the section tables each miss the other's words
+        chain_table.find(id, v);
+        probe_table.find(id, v);
+    }
+    write_table_stats(out, "Whole text", text_chain.stats());
+    write_table_stats(out, "Whole text", text_probe.stats());
+    write_table_stats(out, "Sections 1-6", chain_table.stats());
+    write_table_stats(out, "Sections 7-12", probe_table.stats());
+}
+
+// "a-b" or just "a", inside sections 0..count-1
+bool parse_section_range(const string& text, size_t count, size_t& first, size_t& last) {
+    const char* begin = text.c_str();
+    char* end;
+    first = last = strtoul(begin, &end, 10);
+    if (end == begin) return false;
+    if (*end == '-') {
+        begin = end + 1;
+        last = strtoul(begin, &end, 10);
+        if (end == begin) return false;
+    }
+    return *end == '\0' && first <= last && last < count;
+}
+
+void write_bad_range(ostream& out, const string& range, const SectionCounts& sc) {
+    out << "Invalid section range '" << range << "' (sections are 0-" << sc.size() - 1 << ")\n";
+}
+
+// top k words of each section in the range, then of the whole range
+void write_section_top(ostream& out, const SectionCounts& sc, const string& range, size_t k) {
+    size_t first, last;
+    if (!parse_section_range(range, sc.size(), first, last)) {
+        write_bad_range(out, range, sc);
+        return;
+    }
+    auto start = high_resolution_clock::now(); // Start timing
+    out << "Top " << k << " Words by Section:\n";
+    for (size_t s = first; s <= last; ++s) {
+        const Section& sec = sc.section(s);
+        out << "Section " << s << ": " << (sec.title.empty() ? "(before the first heading)" : sec.title)
+            << " (" << sc.total_words(s, s) << " words)\n";
+        auto top = top_k_frequent(sc.counts(s).counts(), k);
+        for (size_t i = 0; i < top.size(); ++i) out << "  " << top[i].first << ": " << top[i].second << "\n";
+    }
+    if (first != last) {
+        out << "Sections " << range << " (" << sc.total_words(first, last) << " words)\n";
+        auto top = top_k_frequent(sc.merged(first, last).counts(), k);
+        for (size_t i = 0; i < top.size(); ++i) out << "  " << top[i].first << ": " << top[i].second << "\n";
+    }
+    auto end = high_resolution_clock::now(); // End timing
+    out << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+}
+
+// "a-b:c-d": the k words each range uses most above the other's rate
+void write_section_diff(ostream& out, const SectionCounts& sc, const string& ranges, size_t k) {
+    size_t colon = ranges.find(':');
+    string a = ranges.substr(0, colon), b = colon == string::npos ? string() : ranges.substr(colon + 1);
+    size_t a_first, a_last, b_first, b_last;
+    if (!parse_section_range(a, sc.size(), a_first, a_last)) return write_bad_range(out, a, sc);
+    if (!parse_section_range(b, sc.size(), b_first, b_last)) return write_bad_range(out, b, sc);
+    auto start = high_resolution_clock::now(); // Start timing
+    auto more_a = over_represented(sc, a_first, a_last, b_first, b_last, k);
+    auto more_b = over_represented(sc, b_first, b_last, a_first, a_last, k);
+    auto end = high_resolution_clock::now(); // End timing
+
+    ios::fmtflags flags = out.flags();
+    out << fixed << setprecision(1);
+    out << "Sections " << a << " vs " << b << " (" << sc.total_words(a_first, a_last) << " vs "
+        << sc.total_words(b_first, b_last) << " words, rates per 10000 words):\n";
+    out << "More frequent in " << a << ":\n";
+    for (size_t i = 0; i < more_a.size(); ++i) {
+        out << "  " << more_a[i].word << ": " << more_a[i].count_a << " (" << more_a[i].rate_a << ") vs "
+            << more_a[i].count_b << " (" << more_a[i].rate_b << ")\n";
+    }
+    out << "More frequent in " << b << ":\n";
+    for (size_t i = 0; i < more_b.size(); ++i) {
+        out << "  " << more_b[i].word << ": " << more_b[i].count_a << " (" << more_b[i].rate_a << ") vs "
+            << more_b[i].count_b << " (" << more_b[i].rate_b << ")\n";
+    }
+    out.flags(flags);
+    out << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns\n";
+}
+
+int main(int argc, char* argv[]) {
+    // <input_file> <output_file> [--threads N] [--snapshot FILE] [queries]
+    //
+    // With any of the queries below the menu is skipped: they run in the
+    // order given, all into the one output file ("-" for stdout), and the
+    // program exits. KEYS are separated by '@@@' like in the menu, and
+    // sections are numbered from the first heading (0 is the text before it).
+    //   --top N  --bottom N  --search KEYS  --substrings KEYS
+    //   --sections A-B  --compare A-B:C-D
+    //   --sentences  --experiments  --stats
+    unsigned threads = 1;
+    string snapshot_path;
+    ResizableArray<pair<string,string>> queries;
+    bool args_ok = argc >= 3;
+    for (int a = 3; args_ok && a < argc; ++a) {
+        string flag = argv[a];
+        if (flag == "--sentences" || flag == "--experiments" || flag == "--stats") {
+            queries.push_back(make_pair(flag, string()));
+        } else if (a + 1 == argc) {
+            args_ok = false;
+        } else if (flag == "--threads") {
+            threads = static_cast<unsigned>(strtoul(argv[++a], nullptr, 10));
+        } else if (flag == "--snapshot") {
+            snapshot_path = argv[++a];
+        } else if (flag == "--top" || flag == "--bottom" || flag == "--search" || flag == "--substrings" ||
+                   flag == "--sections" || flag == "--compare") {
+            queries.push_back(make_pair(flag, string(argv[++a])));
+        } else {
+            args_ok = false;
         }
-        if (!found) freq_list.push_back(make_pair(w, 1));
+    }
+    if (!args_ok) {
+        cerr << "Usage: " << argv[0] << " <input_file> <output_file> [--threads N] [--snapshot FILE]"
+             << " [--top N] [--bottom N] [--search KEYS] [--substrings KEYS] [--sections A-B] [--compare A-B:C-D]"
+             << " [--sentences] [--experiments] [--stats]";
+        return 1;
+    }
+    bool batch = !queries.empty();
+    bool to_stdout = batch && string(argv[2]) == "-";
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    MappedFile infile(argv[1]);
+    ofstream outfile;
+    if (!to_stdout) outfile.open(argv[2]);
+    if (!infile.is_open() || (!to_stdout && !outfile)) {
+        cerr << "Error opening files";
+        return 1;
     }
 
-    
-  
+    // Every distinct word is stored once in the pool; the token stream,
+    // frequency list, tables and index all hold 32-bit word ids.
+    StringPool words;
+    ResizableArray<uint32_t> tokens;
+    ResizableArray<pair<uint32_t,int>> freq_list;
+    InvertedIndex search_index;
+    size_t sentence_count;
+    long long sentence_count_runtime_ns;
+    ChainingHash<uint32_t,int,IdHash> chain_table(TABLE_SIZE);
+    ProbingHash<uint32_t,int,IdHash> probe_table(TABLE_SIZE, MAX_LOAD);
 
-    // Insert tokens into hash tables
-    const size_t TABLE_SIZE = 20011;
-    const double MAX_LOAD = 0.7;
-    ChainingHash<string,int> chain_table(TABLE_SIZE);
-    ProbingHash<string,int> probe_table(TABLE_SIZE, MAX_LOAD);
+    // With --snapshot, a snapshot of this exact input replaces reading and
+    // counting it; otherwise everything is built below and the snapshot is
+    // (re)written for next time. The body is only looked at when needed.
+    string_view body;
+    // per-section counts, built from the body the first time they're needed
+    unique_ptr<SectionCounts> sections;
+    auto section_counts = [&]() -> const SectionCounts& {
+        if (!sections) {
+            if (body.data() == nullptr) body = gutenberg_body(infile.view());
+            sections = make_unique<SectionCounts>(body, threads);
+        }
+        return *sections;
+    };
+    SourceStamp stamp = {0, 0};
+    bool stamped = !snapshot_path.empty() && source_stamp(argv[1], stamp);
+    Snapshot snapshot(stamped ? snapshot_path : string(), stamp);
+    bool loaded = stamped && snapshot.ok();
+    // the token stream; after a snapshot load it's copied out of the mapping
+    // the first time a query needs it
+    auto token_stream = [&]() -> const ResizableArray<uint32_t>& {
+        if (loaded && tokens.size() < snapshot.token_count() && !snapshot.copy_tokens(tokens)) {
+            cerr << "Snapshot " << snapshot_path << " has a bad token id" << endl;
+            exit(1);
+        }
+        return tokens;
+    };
+    if (loaded) {
+        for (uint32_t id = 0; id < snapshot.unique_words(); ++id) {
+            words.intern(snapshot.word(id));
+            freq_list.push_back(make_pair(id, snapshot.count(id)));
+        }
+        search_index = snapshot.index();
+        // the count and the time it took when the snapshot was built
+        sentence_count = snapshot.sentences();
+        sentence_count_runtime_ns = snapshot.sentence_ns();
+        // each table is filled in batches (see HASH_BATCH)
+        ResizableArray<uint32_t> ids;
+        ResizableArray<int> values;
+        auto collect = [&](uint32_t id, int v) { ids.push_back(id); values.push_back(v); };
+        snapshot.for_each_chain_entry(collect);
+        chain_table.insert_batch(ids.begin(), values.begin(), ids.size());
+        ids.clear();
+        values.clear();
+        snapshot.for_each_probe_entry(collect);
+        probe_table.insert_batch(ids.begin(), values.begin(), ids.size());
+        // stdout may be the report in batch mode
+        (batch ? cerr : cout) << "Loaded snapshot " << snapshot_path << endl;
+    } else {
+        // The body is a view into the mapped file: no copy of the text is made.
+        // Tokens are lowercased as they're cut, and count_sentences only looks
+        // at punctuation, so the text itself never needs lowercasing.
+        body = gutenberg_body(infile.view());
 
-    // Insert tokens into hash tables based on sections
-    int section = 0;
-    int v;
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        const string& w = tokens[i];
+        // Tokenize text and build frequency table in the same pass. Ids come
+        // out in first-occurrence order, so counts indexed by id already are
+        // the frequency list. With more than one thread the pass, index
+        // included, is split across them (see intern_tokens_parallel).
+        if (threads > 1) {
+            intern_tokens_parallel(body, threads, words, tokens, freq_list, search_index);
+        } else {
+            for_each_token_simd(body, [&](string_view w) {
+                uint32_t id = words.intern(w);
+                tokens.push_back(id);
+                if (id == freq_list.size()) freq_list.push_back(make_pair(id, 0));
+                freq_list[id].second++;
+                search_index.add(id);
+            });
+        }
+
+        // Count sentences
+        auto start_sentence_count = high_resolution_clock::now(); // Start timing for sentence count
+        sentence_count = count_sentences_simd(body);
+        auto end_sentence_count = high_resolution_clock::now(); // End timing for sentence count
+        sentence_count_runtime_ns = duration_cast<nanoseconds>(end_sentence_count - start_sentence_count).count();
+
+        // Sections I-VI go into the chaining table and VII-XII into the
+        // probing table, each section's counts added in one batched call
+        const SectionCounts& sc = section_counts();
+        for (size_t s = 1; s < sc.size() && s <= 12; ++s) {
+            const ResizableArray<pair<string,int>>& counted = sc.counts(s).counts();
+            ResizableArray<uint32_t> ids;
+            ResizableArray<int> deltas;
+            for (size_t i = 0; i < counted.size(); ++i) {
+                uint32_t id;
+                bool known = words.lookup(counted[i].first, id);
+                assert(known && "section word missing from the pool");
+                (void)known;
+                ids.push_back(id);
+                deltas.push_back(counted[i].second);
+            }
+            if (s <= 6) chain_table.increment_batch(ids.begin(), ids.size(), deltas.begin());
+            else probe_table.increment_batch(ids.begin(), ids.size(), deltas.begin());
+        }
 
-        // Detect section headers and update the section count
-        if (is_section_header(w)) {
-            section++;
-            continue;
+        if (stamped && !write_snapshot(snapshot_path, stamp, words, freq_list, tokens, search_index, sentence_count,
+                                       sentence_count_runtime_ns, chain_table, probe_table)) {
+            cerr << "Could not write snapshot " << snapshot_path << endl;
         }
+    }
 
-        // Insert into the appropriate hash table based on the section
-        if (section >= 1 && section <= 6) {
-            chain_table.find(w, v) ? chain_table.insert(w, v + 1) : chain_table.insert(w, 1);
-        } else if (section >= 7 && section <= 12) {
-            probe_table.find(w, v) ? probe_table.insert(w, v + 1) : probe_table.insert(w, 1);
+    if (batch) {
+        ostream& out = to_stdout ? cout : outfile;
+        for (size_t q = 0; q < queries.size(); ++q) {
+            const string& what = queries[q].first;
+            const string& arg = queries[q].second;
+            if (what == "--top" || what == "--bottom") {
+                write_top_words(out, words, freq_list, strtoul(arg.c_str(), nullptr, 10), what == "--top");
+            } else if (what == "--search") {
+                write_key_search(out, words, search_index, arg);
+            } else if (what == "--substrings") {
+                if (body.data() == nullptr) body = gutenberg_body(infile.view());
+                write_substring_search(out, body, arg);
+            } else if (what == "--sentences") {
+                write_sentence_count(out, sentence_count, sentence_count_runtime_ns);
+            } else if (what == "--sections") {
+                write_section_top(out, section_counts(), arg, 10);
+            } else if (what == "--compare") {
+                write_section_diff(out, section_counts(), arg, 20);
+            } else if (what == "--experiments") {
+                run_experiments(out, words, token_stream());
+            } else {
+                write_hash_stats(out, words, token_stream(), chain_table, probe_table);
+            }
         }
+        out.flush();
+        return out ? 0 : 1;
     }
 
     int choice;
     do {
         menu();
-        cin >> choice;
+        if (!(cin >> choice)) choice = 0; // end of input exits too
         switch (choice) {
             case 1: {
                 ofstream of(argv[2], ios::trunc);
-                auto start = high_resolution_clock::now(); // Start timing
-                sort_freq_desc(freq_list);
-                auto end = high_resolution_clock::now(); // End timing
-                of << "Top 80 Words:" << endl;
-                for (size_t i = 0; i < 80 && i < freq_list.size(); ++i) {
-                    of << freq_list[i].first << ": " << freq_list[i].second << endl;
-                }
-                of << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns" << endl;
+                write_top_words(of, words, freq_list, 80, true);
                 cout << "Top 80 words written to output file." << endl;
                 break;
             }
             case 2: {
                 ofstream of(argv[2], ios::trunc);
-                auto temp = freq_list;
-                auto start = high_resolution_clock::now(); // Start timing
-                sort_freq_asc(temp);
-                auto end = high_resolution_clock::now(); // End timing
-                of << "Bottom 80 Words:" << endl;
-                for (size_t i = 0; i < 80 && i < temp.size(); ++i) {
-                    of << temp[i].first << ": " << temp[i].second << endl;
-                }
-                of << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns" << endl;
+                write_top_words(of, words, freq_list, 80, false);
                 cout << "Bottom 80 words written to output file." << endl;
                 break;
             }
@@ -320,43 +740,59 @@ int main(int argc, char* argv[]) {
                 cout << "Enter up to 8 keys separated by '@@@': ";
                 string line;
                 getline(cin, line);
-                ResizableArray<string> keys;
-                size_t pos = 0;
-                while ((pos = line.find("@@@")) != string::npos) {
-                    keys.push_back(clean_token(line.substr(0, pos)));
-                    line.erase(0, pos + 3);
-                }
-                if (!line.empty()) keys.push_back(clean_token(line));
-                auto start = high_resolution_clock::now(); // Start timing
-                of << "Key Search Results:" << endl;
-                for (size_t k = 0; k < keys.size(); ++k) {
-                    auto positions = rabin_karp(tokens, keys[k]);
-                    of << "Key '" << keys[k] << "' at positions: ";
-                    for (size_t pidx = 0; pidx < positions.size(); ++pidx) {
-                        of << positions[pidx] << " ";
-                    }
-                    of << endl;
-                }
-                auto end = high_resolution_clock::now(); // End timing
-                of << "Runtime: " << duration_cast<nanoseconds>(end - start).count() << " ns" << endl;
+                write_key_search(of, words, search_index, line);
                 cout << "Key search results written to output file." << endl;
                 break;
             }
             case 4: {
                 ofstream of(argv[2], ios::trunc);
-                of << "Sentence count: " << sentence_count << endl;
-                of << "Runtime: " << sentence_count_runtime_ns << " ns" << endl; // Use pre-measured runtime
+                write_sentence_count(of, sentence_count, sentence_count_runtime_ns);
                 cout << "Sentence count written to output file." << endl;
                 break;
             }
             case 5: {
                 ofstream of(argv[2], ios::trunc);
-                streambuf* orig = cout.rdbuf(of.rdbuf());
-                run_experiments(tokens); // No runtime output for #5
-                cout.rdbuf(orig);
+                run_experiments(of, words, token_stream()); // No runtime output for #5
                 cout << "Experiments completed. Results written to output file." << endl;
                 break;
             }
+            case 6: {
+                ofstream of(argv[2], ios::trunc);
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Enter up to 8 substrings separated by '@@@': ";
+                string line;
+                getline(cin, line);
+                if (body.data() == nullptr) body = gutenberg_body(infile.view());
+                write_substring_search(of, body, line);
+                cout << "Substring search results written to output file." << endl;
+                break;
+            }
+            case 7: {
+                ofstream of(argv[2], ios::trunc);
+                write_hash_stats(of, words, token_stream(), chain_table, probe_table);
+                cout << "Hash table statistics written to output file." << endl;
+                break;
+            }
+            case 8: {
+                ofstream of(argv[2], ios::trunc);
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Enter a range of sections (e.g. 1-6): ";
+                string range;
+                getline(cin, range);
+                write_section_top(of, section_counts(), range, 10);
+                cout << "Section results written to output file." << endl;
+                break;
+            }
+            case 9: {
+                ofstream of(argv[2], ios::trunc);
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                cout << "Enter two ranges of sections (e.g. 1-6:7-12): ";
+                string ranges;
+                getline(cin, ranges);
+                write_section_diff(of, section_counts(), ranges, 20);
+                cout << "Section comparison written to output file." << endl;
+                break;
+            }
             case 0:
                 cout << "Exiting program." << endl;
                 break;
@@ -1,75 +1,175 @@
-template<typename T>
+#ifndef FINAL_ASSIGNMENT_H
+#define FINAL_ASSIGNMENT_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Growable array on raw storage: slots past size() are never constructed,
+// and growing moves elements across with move_if_noexcept (so strings and
+// vectors just hand over their buffers) instead of default-constructing a
+// new array and copy-assigning into it. Memory comes from Alloc, e.g. an
+// ArenaAllocator (Arena.h) to carve arrays out of one arena.
+template<typename T, typename Alloc = std::allocator<T>>
 class ResizableArray {
+    typedef std::allocator_traits<Alloc> traits;
+
 public:
-    ResizableArray() : data(nullptr), cap(0), len(0) {}
+    typedef T value_type;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    ResizableArray() : alloc(), buf(nullptr), cap(0), len(0) {}
+    explicit ResizableArray(const Alloc& a) : alloc(a), buf(nullptr), cap(0), len(0) {}
 
     // Copy constructor
-    ResizableArray(const ResizableArray& other) : data(nullptr), cap(other.cap), len(other.len) {
-        if (cap > 0) {
-            data = new T[cap];
-            for (size_t i = 0; i < len; ++i) {
-                data[i] = other.data[i];
-            }
-        }
+    ResizableArray(const ResizableArray& other)
+      : alloc(traits::select_on_container_copy_construction(other.alloc)), buf(nullptr), cap(0), len(0) {
+        reserve(other.len);
+        for (const T& v : other) emplace_back(v);
     }
 
     // Move constructor
-    ResizableArray(ResizableArray&& other) noexcept : data(other.data), cap(other.cap), len(other.len) {
-        other.data = nullptr;
+    ResizableArray(ResizableArray&& other) noexcept
+      : alloc(std::move(other.alloc)), buf(other.buf), cap(other.cap), len(other.len) {
+        other.buf = nullptr;
         other.cap = 0;
         other.len = 0;
     }
 
-    // Copy assignment operator
+    // Copy assignment operator; keeps this array's allocator
     ResizableArray& operator=(const ResizableArray& other) {
         if (this != &other) {
-            delete[] data;
-            cap = other.cap;
-            len = other.len;
-            data = (cap > 0) ? new T[cap] : nullptr;
-            for (size_t i = 0; i < len; ++i) {
-                data[i] = other.data[i];
-            }
+            clear();
+            reserve(other.len);
+            for (const T& v : other) emplace_back(v);
         }
         return *this;
     }
 
-    // Move assignment operator
-    ResizableArray& operator=(ResizableArray&& other) noexcept {
-        if (this != &other) {
-            delete[] data;
-            data = other.data;
+    // Move assignment operator. Takes the other buffer when the allocators
+    // can free each other's memory, otherwise moves element by element.
+    ResizableArray& operator=(ResizableArray&& other) noexcept(traits::propagate_on_container_move_assignment::value ||
+                                                                traits::is_always_equal::value) {
+        if (this == &other) return *this;
+        if (traits::propagate_on_container_move_assignment::value || alloc == other.alloc) {
+            release();
+            if (traits::propagate_on_container_move_assignment::value) alloc = std::move(other.alloc);
+            buf = other.buf;
             cap = other.cap;
             len = other.len;
-            other.data = nullptr;
+            other.buf = nullptr;
             other.cap = 0;
             other.len = 0;
+        } else {
+            clear();
+            reserve(other.len);
+            for (T& v : other) emplace_back(std::move(v));
+            other.clear();
         }
         return *this;
     }
 
     // Destructor
-    ~ResizableArray() { delete[] data; }
+    ~ResizableArray() { release(); }
+
+    void push_back(const T& val) { emplace_back(val); }
+    void push_back(T&& val) { emplace_back(std::move(val)); }
+
+    // builds the element in place. When the array has to grow, the new
+    // element is built first, so args may refer to an element of this array.
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (len < cap) {
+            traits::construct(alloc, buf + len, std::forward<Args>(args)...);
+        } else {
+            size_t new_cap = (cap == 0 ? 10 : cap * 2);
+            T* fresh = traits::allocate(alloc, new_cap);
+            try {
+                traits::construct(alloc, fresh + len, std::forward<Args>(args)...);
+            } catch (...) {
+                traits::deallocate(alloc, fresh, new_cap);
+                throw;
+            }
+            relocate(fresh, new_cap, 1);
+        }
+        return buf[len++];
+    }
+
+    void pop_back() {
+        assert(len > 0);
+        traits::destroy(alloc, buf + --len);
+    }
+
+    // room for at least n elements without another reallocation
+    void reserve(size_t n) {
+        if (n <= cap) return;
+        relocate(traits::allocate(alloc, n), n, 0);
+    }
+
+    // drop unused capacity
+    void shrink_to_fit() {
+        if (len == cap) return;
+        if (len == 0) {
+            release();
+            return;
+        }
+        relocate(traits::allocate(alloc, len), len, 0);
+    }
 
-    void push_back(const T& val) {
-        if (len == cap) resize();
-        data[len++] = val;
+    void clear() {
+        for (size_t i = len; i > 0; --i) traits::destroy(alloc, buf + i - 1);
+        len = 0;
     }
 
-    T& operator[](size_t idx) { assert(idx < len); return data[idx]; }
-    const T& operator[](size_t idx) const { assert(idx < len); return data[idx]; }
+    T& operator[](size_t idx) { assert(idx < len); return buf[idx]; }
+    const T& operator[](size_t idx) const { assert(idx < len); return buf[idx]; }
+    T& back() { assert(len > 0); return buf[len - 1]; }
+    const T& back() const { assert(len > 0); return buf[len - 1]; }
+
     size_t size() const { return len; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return len == 0; }
+
+    iterator begin() { return buf; }
+    iterator end() { return buf + len; }
+    const_iterator begin() const { return buf; }
+    const_iterator end() const { return buf + len; }
 
 private:
-    void resize() {
-        cap = (cap == 0 ? 10 : cap * 2);
-        T* newdata = new T[cap];
-        for (size_t i = 0; i < len; ++i) newdata[i] = data[i];
-        delete[] data;
-        data = newdata;
+    // Move the elements into fresh (capacity new_cap) and free the old
+    // buffer. `extra` slots after the elements are already built in fresh
+    // and are torn down too if a copy throws.
+    void relocate(T* fresh, size_t new_cap, size_t extra) {
+        size_t done = 0;
+        try {
+            for (; done < len; ++done) traits::construct(alloc, fresh + done, std::move_if_noexcept(buf[done]));
+        } catch (...) {
+            for (size_t i = 0; i < done; ++i) traits::destroy(alloc, fresh + i);
+            for (size_t i = 0; i < extra; ++i) traits::destroy(alloc, fresh + len + i);
+            traits::deallocate(alloc, fresh, new_cap);
+            throw;
+        }
+        size_t n = len;
+        release();
+        buf = fresh;
+        cap = new_cap;
+        len = n;
     }
 
-    T* data;
+    void release() {
+        clear();
+        if (buf) traits::deallocate(alloc, buf, cap);
+        buf = nullptr;
+        cap = 0;
+    }
+
+    Alloc alloc;
+    T* buf;
     size_t cap;
     size_t len;
 };
+
+#endif // FINAL_ASSIGNMENT_H
@@ -0,0 +1,250 @@
+#ifndef FLAT_HASH_H
+#define FLAT_HASH_H
+
+#include "HashTable.h"
+#include "HashFunctions.h"
+#include <vector>
+#include <functional>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+using namespace std;
+
+// Open addressing with everything the counting loop touches fixed at
+// compile time: no virtual calls, the hasher and the key comparison
+// inlined, and a power-of-two slot count, so the home slot is the top bits
+// of the mixed hash (a shift) and the next probe is a mask.
+//
+//   Hasher   - any policy from HashFunctions.h
+//   KeyEqual - key comparison; the default equal_to<> is transparent, so a
+//              string-keyed table can be searched with a string_view
+//   Probe    - LinearProbe or QuadraticProbe
+//   Capacity - FixedCapacity<N>: N slots for good, so the shift and mask
+//              are constants; GrowingCapacity<N>: starts at N and doubles
+//              at max load
+//
+// Erased slots are tombstones; like ProbingHash, a new key reuses the
+// first one on its probe sequence and the table is rebuilt once they're a
+// quarter of it. HashTableAdapter puts one behind the HashTable interface.
+
+constexpr bool is_power_of_two(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+
+constexpr size_t log2_of(size_t n) { return n <= 1 ? 0 : 1 + log2_of(n / 2); }
+
+constexpr size_t round_up_power_of_two(size_t n) {
+    size_t p = 2;
+    while (p < n) p *= 2;
+    return p;
+}
+
+// the slot after the step-th probe
+struct LinearProbe {
+    static size_t next(size_t idx, size_t, size_t mask) { return (idx + 1) & mask; }
+};
+
+// triangular steps (+1, +2, +3, ...) reach every slot of a power-of-two
+// table and break up the runs linear probing builds behind busy slots
+struct QuadraticProbe {
+    static size_t next(size_t idx, size_t step, size_t mask) { return (idx + step) & mask; }
+};
+
+// The table keeps its current slot count and shift and asks the policy for
+// them on every access; a fixed policy answers with constants instead.
+template<size_t Slots, unsigned MaxLoadPercent = 70>
+struct FixedCapacity {
+    static_assert(is_power_of_two(Slots) && Slots >= 2, "FixedCapacity needs a power of two");
+    static_assert(MaxLoadPercent > 0 && MaxLoadPercent < 100, "a probe needs a free slot to stop at");
+    static constexpr size_t initial = Slots;
+    static constexpr bool can_grow = false;
+    static constexpr unsigned max_load_percent = MaxLoadPercent;
+    static constexpr size_t slots(size_t) { return Slots; }
+    static constexpr unsigned shift(unsigned) { return 64 - log2_of(Slots); }
+};
+
+template<size_t InitialSlots = 16, unsigned MaxLoadPercent = 70>
+struct GrowingCapacity {
+    static_assert(is_power_of_two(InitialSlots) && InitialSlots >= 2, "GrowingCapacity needs a power of two");
+    static_assert(MaxLoadPercent > 0 && MaxLoadPercent < 100, "a probe needs a free slot to stop at");
+    static constexpr size_t initial = InitialSlots;
+    static constexpr bool can_grow = true;
+    static constexpr unsigned max_load_percent = MaxLoadPercent;
+    static size_t slots(size_t current) { return current; }
+    static unsigned shift(unsigned current) { return current; }
+};
+
+template<typename Key, typename Value, typename Hasher = WyHash, typename KeyEqual = equal_to<>,
+         typename Probe = LinearProbe, typename Capacity = GrowingCapacity<>>
+class FlatHash {
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+
+    // min_slots is rounded up to a power of two; a fixed table ignores it
+    explicit FlatHash(size_t min_slots = Capacity::initial, const Hasher& hf = Hasher(), const KeyEqual& eq = KeyEqual())
+      : hasher(hf), equal(eq) {
+        allocate(Capacity::can_grow ? round_up_power_of_two(min_slots) : Capacity::initial);
+    }
+
+    void insert(const Key& key, const Value& value) { find_or_insert(key, value) = value; }
+
+    template<typename K>
+    void increment(const K& key, const Value& delta = Value(1)) { find_or_insert(key, Value()) += delta; }
+
+    // the stored value, after inserting initial if the key is new; a Key
+    // is only built from K in that case
+    template<typename K>
+    Value& find_or_insert(const K& key, const Value& initial) {
+        uint64_t h = hasher(key);
+        size_t mask = slot_count() - 1, idx = home(h), tomb = NONE;
+        for (size_t step = 1;; ++step) {
+            if (state[idx] == FULL && equal(slots[idx].first, key)) return slots[idx].second;
+            if (state[idx] == EMPTY) break;
+            if (state[idx] == DELETED && tomb == NONE) tomb = idx;
+            idx = Probe::next(idx, step, mask);
+        }
+        if (tomb != NONE) {
+            idx = tomb;
+            deleted--;
+        } else if (count + deleted + 1 > limit()) {
+            make_room();
+            idx = free_slot(h);
+        }
+        state[idx] = FULL;
+        slots[idx].first = Key(key);
+        slots[idx].second = initial;
+        count++;
+        return slots[idx].second;
+    }
+
+    template<typename K>
+    bool find(const K& key, Value& value_out) const {
+        size_t idx = locate(key);
+        if (idx == NONE) return false;
+        value_out = slots[idx].second;
+        return true;
+    }
+
+    template<typename K>
+    bool erase(const K& key) {
+        size_t idx = locate(key);
+        if (idx == NONE) return false;
+        state[idx] = DELETED;
+        slots[idx] = pair<Key,Value>();
+        count--;
+        deleted++;
+        if (deleted > slot_count() / 4) rehash(slot_count());
+        return true;
+    }
+
+    size_t size() const { return count; }
+    double load_factor() const { return static_cast<double>(count) / slot_count(); }
+    size_t capacity() const { return slot_count(); }
+
+    // fn(key, value) for every entry, in slot order
+    template<typename Fn>
+    void for_each(Fn fn) const {
+        for (size_t i = 0; i < slot_count(); ++i) {
+            if (state[i] == FULL) fn(slots[i].first, slots[i].second);
+        }
+    }
+
+private:
+    static constexpr uint8_t EMPTY = 0, FULL = 1, DELETED = 2;
+    static constexpr size_t NONE = ~size_t(0);
+
+    Hasher hasher;
+    KeyEqual equal;
+    size_t cap;
+    unsigned cap_shift;
+    size_t count;
+    size_t deleted;
+    vector<uint8_t> state;
+    vector<pair<Key,Value>> slots;
+
+    size_t slot_count() const { return Capacity::slots(cap); }
+    size_t home(uint64_t h) const { return static_cast<size_t>(hash_mix(h) >> Capacity::shift(cap_shift)); }
+    size_t limit() const { return slot_count() * Capacity::max_load_percent / 100; }
+
+    template<typename K>
+    size_t locate(const K& key) const {
+        size_t mask = slot_count() - 1, idx = home(hasher(key));
+        for (size_t step = 1;; ++step) {
+            if (state[idx] == EMPTY) return NONE;
+            if (state[idx] == FULL && equal(slots[idx].first, key)) return idx;
+            idx = Probe::next(idx, step, mask);
+        }
+    }
+
+    // first slot that isn't FULL on the probe sequence of h
+    size_t free_slot(uint64_t h) const {
+        size_t mask = slot_count() - 1, idx = home(h);
+        for (size_t step = 1; state[idx] == FULL; ++step) idx = Probe::next(idx, step, mask);
+        return idx;
+    }
+
+    // tombstones alone filling the table only needs a rebuild at this size
+    void make_room() {
+        if (count + 1 <= limit() / 2 || !Capacity::can_grow) {
+            assert(count + 1 <= limit() && "FlatHash is full");
+            rehash(slot_count());
+        } else {
+            rehash(slot_count() * 2);
+        }
+    }
+
+    void allocate(size_t n) {
+        cap = n;
+        cap_shift = static_cast<unsigned>(64 - log2_of(n));
+        count = 0;
+        deleted = 0;
+        state.assign(n, EMPTY);
+        slots.clear();
+        slots.resize(n);
+    }
+
+    void rehash(size_t n) {
+        vector<uint8_t> old_state;
+        vector<pair<Key,Value>> old_slots;
+        old_state.swap(state);
+        old_slots.swap(slots);
+        allocate(n);
+        for (size_t i = 0; i < old_state.size(); ++i) {
+            if (old_state[i] != FULL) continue;
+            size_t idx = free_slot(hasher(old_slots[i].first));
+            state[idx] = FULL;
+            slots[idx] = move(old_slots[i]);
+            count++;
+        }
+    }
+};
+
+// A table with the FlatHash interface behind the virtual HashTable one, for
+// code written against HashTable&. Every call through the base class pays
+// the dispatch the table itself avoids.
+template<typename Table>
+class HashTableAdapter : public HashTable<typename Table::key_type, typename Table::mapped_type> {
+    typedef typename Table::key_type Key;
+    typedef typename Table::mapped_type Value;
+
+public:
+    explicit HashTableAdapter(size_t min_slots) : table(min_slots) {}
+
+    void insert(const Key& key, const Value& value) override { table.insert(key, value); }
+    bool find(const Key& key, Value& value_out) const override { return table.find(key, value_out); }
+    Value& find_or_insert(const Key& key, const Value& initial) override { return table.find_or_insert(key, initial); }
+    bool erase(const Key& key) override { return table.erase(key); }
+    size_t size() const override { return table.size(); }
+    double load_factor() const override { return table.load_factor(); }
+    void increment(const Key& key, const Value& delta = Value(1)) override { table.increment(key, delta); }
+
+    Table& get() { return table; }
+    const Table& get() const { return table; }
+
+private:
+    Table table;
+};
+
+#endif // FLAT_HASH_H
@@ -0,0 +1,96 @@
+#ifndef HASH_FUNCTIONS_H
+#define HASH_FUNCTIONS_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+using namespace std;
+
+// Hasher policies for the tables. Each one hashes a key to 64 bits once;
+// the table then turns that into a bucket with bucket_index() instead of
+// taking a % on every character. They take string_view so a string and a
+// view of the same bytes hash the same.
+
+// Horners rule
+struct HornerHash {
+    uint64_t operator()(string_view s) const {
+        uint64_t h = 0;
+        for (char c : s) h = h * 31 + static_cast<unsigned char>(c);
+        return h;
+    }
+};
+
+// sum of the characters; anagrams always collide
+struct SimpleModHash {
+    uint64_t operator()(string_view s) const {
+        uint64_t sum = 0;
+        for (char c : s) sum += static_cast<unsigned char>(c);
+        return sum;
+    }
+};
+
+// FNV-1a, 64 bit, one byte at a time
+struct FNV1aHash {
+    uint64_t operator()(string_view s) const {
+        uint64_t h = 14695981039346656037ULL;
+        for (char c : s) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+};
+
+// wyhash-style: eats 8 bytes per step and mixes with a 64x64->128 multiply.
+// Same idea and constants as wyhash, not bit-compatible with it.
+struct WyHash {
+    uint64_t operator()(string_view s) const {
+        const char* p = s.data();
+        size_t n = s.size();
+        uint64_t h = 0xa0761d6478bd642fULL ^ n;
+        while (n > 8) {
+            h = mum(h ^ read8(p, 8), 0xe7037ed1a0b428dbULL);
+            p += 8;
+            n -= 8;
+        }
+        return mum(h ^ read8(p, n), 0x8ebc6af09c88c6e3ULL ^ s.size());
+    }
+
+private:
+    static uint64_t read8(const char* p, size_t n) {
+        uint64_t w = 0;
+        memcpy(&w, p, n);
+        return w;
+    }
+    static uint64_t mum(uint64_t a, uint64_t b) {
+        unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+    }
+};
+
+// for tables keyed by StringPool ids: the id already is a perfect hash of
+// its word, and bucket_index's multiply spreads the dense ids out
+struct IdHash {
+    uint64_t operator()(uint32_t id) const { return id; }
+};
+
+// Fibonacci multiply so weak hashes (Horner on short words only fills the
+// low bits) still reach every bucket, then fastrange: the high 64 bits of
+// mixed * n are uniform in [0, n) without a division. For power-of-two n
+// this is the same as masking the top log2(n) bits.
+inline uint64_t hash_mix(uint64_t h) {
+    return h * 0x9E3779B97F4A7C15ULL;
+}
+
+inline size_t fast_range(uint64_t h, size_t n) {
+    return static_cast<size_t>((static_cast<unsigned __int128>(h) * n) >> 64);
+}
+
+inline size_t bucket_index(uint64_t h, size_t n) {
+    return fast_range(hash_mix(h), n);
+}
+
+#endif // HASH_FUNCTIONS_H
@@ -3,6 +3,8 @@
 
 #include <string>
 #include <cassert>
+#include <cstdint>
+#include <algorithm>
 
 using namespace std;
 
@@ -12,8 +14,39 @@ public:
     virtual ~HashTable() {}
     virtual void insert(const Key& key, const Value& value) = 0;
     virtual bool find(const Key& key, Value& value_out) const = 0;
+    // one hash and one probe sequence: returns the stored value, inserting
+    // `initial` first if the key is new. The reference is only good until
+    // the next insert.
+    virtual Value& find_or_insert(const Key& key, const Value& initial) = 0;
+    // remove the key; false if it wasn't there
+    virtual bool erase(const Key& key) = 0;
     virtual size_t size() const = 0;
     virtual double load_factor() const = 0;
+
+    // add delta to the key's value, starting from Value() if it's new;
+    // concurrent tables override this to do it as one locked step
+    virtual void increment(const Key& key, const Value& delta = Value(1)) {
+        find_or_insert(key, Value()) += delta;
+    }
 };
 
+// Batched operations (insert_batch, increment_batch, find_batch) work
+// through their keys HASH_BATCH at a time: the whole group is hashed and
+// where each key will be looked for is prefetched, then the lookups run,
+// so the group's cache misses overlap instead of each key waiting on the
+// one before it. That only pays once the table is bigger than the cache.
+const size_t HASH_BATCH = 16;
+
+// prefetch(keys + base, m, h) hashes a group into h[0..m) and issues its
+// prefetches; fn(i, h) then does key i
+template<typename K, typename Prefetch, typename Fn>
+void in_batches(const K* keys, size_t n, Prefetch prefetch, Fn fn) {
+    uint64_t h[HASH_BATCH];
+    for (size_t base = 0; base < n; base += HASH_BATCH) {
+        size_t m = min(HASH_BATCH, n - base);
+        prefetch(keys + base, m, h);
+        for (size_t i = 0; i < m; ++i) fn(base + i, h[i]);
+    }
+}
+
 #endif // HASHTABLE_H
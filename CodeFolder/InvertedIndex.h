@@ -0,0 +1,221 @@
+#ifndef INVERTED_INDEX_H
+#define INVERTED_INDEX_H
+
+#include "FinalAssignment.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <thread>
+
+using namespace std;
+
+// Positional inverted index: word -> every token position it appears at
+// (1-based, same numbering as the old rabin_karp). Built as tokens go past,
+// so a lookup is a walk of that word's postings instead of a rescan of the
+// whole token array. Words are StringPool ids, which are dense, so the
+// postings lists are just indexed by id.
+//
+// Postings are stored as gaps between positions, LEB128 varint encoded:
+// common words have small gaps that fit in one byte, so the whole index is
+// a little over a byte per token.
+//
+// An index can also be laid over encoded lists someone else keeps, such as
+// a mapped snapshot (see over()); it then reads them in place and can't be
+// added to. Pieces of a text can be indexed separately and join()ed.
+class InvertedIndex {
+public:
+    // skipped > 0 starts the positions after that many tokens, for
+    // indexing a piece of a text that doesn't start at its beginning
+    explicit InvertedIndex(size_t skipped = 0) : tokens(skipped) {}
+
+    // one word's encoded postings, and how many positions they hold
+    struct Encoded {
+        const uint8_t* data;
+        size_t size;
+        size_t count;
+    };
+
+    // Word w's list is bytes[offsets[w], offsets[w + 1]) with counts[w]
+    // positions in it. Nothing is copied, so the arrays have to outlive
+    // the index; every non-empty list must end on a byte without the
+    // varint continuation bit.
+    static InvertedIndex over(const uint8_t* bytes, const uint32_t* offsets, const int32_t* counts,
+                              size_t words, size_t tokens) {
+        InvertedIndex index;
+        index.tokens = tokens;
+        index.mapped = Mapped{bytes, offsets, counts, words};
+        return index;
+    }
+
+    // One index of consecutive pieces of a text, each built with add() and
+    // started after the pieces before it. A word's list is its lists from
+    // the pieces one after the other, with only each piece's first gap
+    // re-encoded, so words are independent: thread t joins the words whose
+    // id is t modulo threads. threads == 0 is taken as 1.
+    static InvertedIndex join(const vector<InvertedIndex>& parts, unsigned threads) {
+        InvertedIndex joined;
+        if (parts.empty()) return joined;
+        threads = max(1u, threads);
+        size_t words = 0;
+        for (const InvertedIndex& part : parts) words = max(words, part.lists.size());
+        joined.lists.reserve(words);
+        for (size_t w = 0; w < words; ++w) joined.lists.push_back(Postings());
+        joined.tokens = parts.back().tokens;
+
+        auto work = [&](unsigned t) {
+            for (size_t w = t; w < words; w += threads) {
+                Postings& out = joined.lists[w];
+                for (const InvertedIndex& part : parts) {
+                    if (part.frequency(static_cast<uint32_t>(w)) == 0) continue;
+                    const Postings& in = part.lists[w];
+                    Cursor first(part.encoded(static_cast<uint32_t>(w)));
+                    first.next();
+                    put_varint(out.bytes, first.pos - out.last);
+                    out.bytes.insert(out.bytes.end(), in.bytes.begin() + first.i, in.bytes.end());
+                    out.last = in.last;
+                    out.count += in.count;
+                }
+            }
+        };
+        vector<thread> pool;
+        for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work, t);
+        work(0);
+        for (auto& t : pool) t.join();
+        return joined;
+    }
+
+    // next token of the text
+    void add(uint32_t word) {
+        assert(mapped.bytes == nullptr && "a mapped index is read-only");
+        while (lists.size() <= word) lists.push_back(Postings());
+        tokens++;
+        Postings& p = lists[word];
+        put_varint(p.bytes, tokens - p.last);
+        p.last = tokens;
+        p.count++;
+    }
+
+    size_t token_count() const { return tokens; }
+    size_t unique_words() const { return mapped.bytes ? mapped.words : lists.size(); }
+
+    // how often word appears; 0 if never
+    size_t frequency(uint32_t word) const { return encoded(word).count; }
+
+    // empty for a word the index has never seen
+    Encoded encoded(uint32_t word) const {
+        if (word >= unique_words()) return Encoded{nullptr, 0, 0};
+        if (mapped.bytes) {
+            return Encoded{mapped.bytes + mapped.offsets[word], mapped.offsets[word + 1] - mapped.offsets[word],
+                           static_cast<size_t>(mapped.counts[word])};
+        }
+        const Postings& p = lists[word];
+        return Encoded{p.bytes.data(), p.bytes.size(), p.count};
+    }
+
+    ResizableArray<size_t> positions(uint32_t word) const {
+        ResizableArray<size_t> out;
+        Cursor c(encoded(word));
+        while (c.next()) out.push_back(c.pos);
+        return out;
+    }
+
+    // Positions where words[0] starts a run of words[0..n-1] in a row.
+    // Candidates come from the word with the shortest encoded list, shifted
+    // back by its offset in the phrase; the other lists are then checked
+    // shortest first at their own offsets, each decoded only as far as the
+    // last candidate, and none at all once no candidate is left.
+    ResizableArray<size_t> phrase(const ResizableArray<uint32_t>& words) const {
+        ResizableArray<size_t> candidates;
+        ResizableArray<size_t> order;
+        for (size_t w = 0; w < words.size(); ++w) {
+            if (frequency(words[w]) == 0) return candidates;
+            order.push_back(w);
+        }
+        if (order.size() == 0) return candidates;
+        sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return encoded(words[a]).size < encoded(words[b]).size;
+        });
+
+        size_t first = order[0];
+        Cursor c(encoded(words[first]));
+        while (c.next()) {
+            if (c.pos > first) candidates.push_back(c.pos - first);
+        }
+        for (size_t k = 1; k < order.size() && candidates.size() > 0; ++k) {
+            size_t w = order[k];
+            Cursor next(encoded(words[w]));
+            bool more = next.next();
+            ResizableArray<size_t> kept;
+            for (size_t i = 0; i < candidates.size() && more; ++i) {
+                size_t want = candidates[i] + w;
+                while (more && next.pos < want) more = next.next();
+                if (more && next.pos == want) kept.push_back(candidates[i]);
+            }
+            candidates = move(kept);
+        }
+        return candidates;
+    }
+
+    // encoded postings bytes across all words
+    size_t postings_bytes() const {
+        size_t total = 0;
+        for (uint32_t w = 0; w < unique_words(); ++w) total += encoded(w).size;
+        return total;
+    }
+
+private:
+    struct Postings {
+        vector<uint8_t> bytes;
+        size_t last = 0;
+        size_t count = 0;
+    };
+
+    struct Mapped {
+        const uint8_t* bytes;
+        const uint32_t* offsets;
+        const int32_t* counts;
+        size_t words;
+    };
+
+    ResizableArray<Postings> lists;
+    size_t tokens;
+    Mapped mapped = Mapped{nullptr, nullptr, nullptr, 0};
+
+    // 7 bits per byte, high bit set on every byte but the last
+    static void put_varint(vector<uint8_t>& out, size_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    // walks a postings list one position at a time
+    struct Cursor {
+        Encoded list;
+        size_t i = 0;
+        size_t pos = 0;
+
+        explicit Cursor(const Encoded& list) : list(list) {}
+
+        // false once the list is used up
+        bool next() {
+            if (i == list.size) return false;
+            size_t gap = 0;
+            int shift = 0;
+            uint8_t b;
+            do {
+                b = list.data[i++];
+                gap |= static_cast<size_t>(b & 0x7F) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            pos += gap;
+            return true;
+        }
+    };
+};
+
+#endif // INVERTED_INDEX_H
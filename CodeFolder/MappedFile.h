@@ -0,0 +1,112 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "TextUtils.h"
+#include "SimdText.h"
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <iterator>
+#include <cstddef>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Read-only view of a whole input file. Regular files are mmap'd, so the
+// text is never copied onto the heap and the kernel can drop pages that
+// have already been tokenized. Anything mmap refuses (pipes, empty files)
+// is read into a string instead and the view points there.
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) : addr(nullptr), len(0), opened(false) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                addr = p;
+                len = st.st_size;
+                madvise(addr, len, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+        if (!addr) {
+            ifstream in(path, ios::binary);
+            if (!in) return;
+            buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        }
+        opened = true;
+    }
+
+    ~MappedFile() {
+        if (addr) munmap(addr, len);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const { return opened; }
+    bool mapped() const { return addr != nullptr; }
+
+    string_view view() const {
+        return addr ? string_view(static_cast<const char*>(addr), len) : string_view(buffer);
+    }
+
+    // Hand the whole pages inside [from, to) back to the kernel. The mapping
+    // is private and read-only, so touching them again just faults them back
+    // in from the file.
+    void release(const char* from, const char* to) {
+        if (!addr) return;
+        char* base = static_cast<char*>(addr);
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t lo = (static_cast<size_t>(from - base) + page - 1) / page * page;
+        size_t hi = static_cast<size_t>(to - base) / page * page;
+        if (hi > lo) madvise(base + lo, hi - lo, MADV_DONTNEED);
+    }
+
+private:
+    void* addr;
+    size_t len;
+    bool opened;
+    string buffer;
+};
+
+// The helpers below walk a view of `file` one window at a time and release
+// each window when they're done with it, so resident memory stays around
+// one window no matter how big the file is.
+const size_t MAPPED_WINDOW = 16 << 20;
+
+// text.find(needle); windows overlap so a match can't fall between two
+inline size_t find(MappedFile& file, string_view text, string_view needle) {
+    for (size_t pos = 0; pos < text.size(); pos += MAPPED_WINDOW) {
+        size_t len = min(text.size() - pos, MAPPED_WINDOW + needle.size() - 1);
+        size_t hit = text.substr(pos, len).find(needle);
+        file.release(text.data() + pos, text.data() + pos + len);
+        if (hit != string_view::npos) return pos + hit;
+    }
+    return string_view::npos;
+}
+
+inline string_view gutenberg_body(MappedFile& file) {
+    string_view text = file.view();
+    return gutenberg_body(text, find(file, text, START_MARKER), find(file, text, END_MARKER));
+}
+
+// windows end on a non-alphanumeric byte so no token is split
+template<typename Fn>
+void for_each_token(MappedFile& file, string_view text, Fn fn) {
+    while (!text.empty()) {
+        size_t cut = min(MAPPED_WINDOW, text.size());
+        while (cut < text.size() && isalnum(static_cast<unsigned char>(text[cut]))) ++cut;
+        for_each_token_simd(text.substr(0, cut), fn);
+        file.release(text.data(), text.data() + cut);
+        text.remove_prefix(cut);
+    }
+}
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,191 @@
+#ifndef PARALLEL_COUNTER_H
+#define PARALLEL_COUNTER_H
+
+#include "FlatHash.h"
+#include "HashFunctions.h"
+#include "FinalAssignment.h"
+#include "SimdText.h"
+#include "StringPool.h"
+#include "InvertedIndex.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+using namespace std;
+
+// Multi-threaded word counting in two phases, neither of which shares a
+// table between threads:
+//  1) count - the text is cut into one piece per thread at non-alphanumeric
+//     bytes, and each thread counts its piece into its own tables, one per
+//     hash partition (a word's partition is picked from its hash)
+//  2) merge - thread p folds partition p of every worker into one table;
+//     a word only ever lands in one partition, so no two threads touch the
+//     same key
+// Every word keeps the position it was first seen at, so the result comes
+// out in the same first-occurrence order as a sequential WordCounter.
+
+// cut text into `parts` pieces that never split a token; pieces can be empty
+inline vector<string_view> split_at_token_boundaries(string_view text, size_t parts) {
+    vector<string_view> pieces;
+    size_t begin = 0;
+    for (size_t k = 1; k <= parts; ++k) {
+        size_t cut = (k == parts) ? text.size() : max(begin, text.size() / parts * k);
+        while (cut < text.size() && is_ascii_alnum(text[cut])) ++cut;
+        pieces.push_back(text.substr(begin, cut - begin));
+        begin = cut;
+    }
+    return pieces;
+}
+
+// one worker's counts for one partition: the same index + dense array
+// layout as WordCounter, plus where each word first showed up
+struct PartialCounts {
+    struct Word {
+        string word;
+        int count;
+        uint64_t first;
+    };
+
+    FlatHash<string,size_t> index;
+    ResizableArray<Word> words;
+
+    PartialCounts() : index(1024) {}
+
+    void add(string_view word, int count, uint64_t first) {
+        size_t slot = index.find_or_insert(word, words.size());
+        if (slot == words.size()) {
+            words.push_back(Word{string(word), count, first});
+        } else {
+            words[slot].count += count;
+        }
+    }
+};
+
+// Same (word, count) list as feeding every token of text through a
+// WordCounter. threads == 0 is taken as 1.
+inline ResizableArray<pair<string,int>> count_words_parallel(string_view text, unsigned threads) {
+    if (threads == 0) threads = 1;
+    vector<string_view> pieces = split_at_token_boundaries(text, threads);
+    vector<vector<PartialCounts>> partial(threads);
+
+    // a position is (piece, token within the piece), packed so that
+    // comparing two of them compares where the tokens are in the text
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            partial[t].resize(threads);
+            WyHash hasher;
+            uint64_t pos = static_cast<uint64_t>(t) << 40;
+            for_each_token_simd(pieces[t], [&](string_view w) {
+                partial[t][fast_range(hasher(w), threads)].add(w, 1, pos++);
+            });
+        });
+    }
+    for (auto& w : workers) w.join();
+    workers.clear();
+
+    // workers are folded in piece order, so the first position a word was
+    // seen at is always the one already in partial[0][p]
+    for (unsigned p = 0; p < threads; ++p) {
+        workers.emplace_back([&, p] {
+            PartialCounts& merged = partial[0][p];
+            for (unsigned t = 1; t < threads; ++t) {
+                const ResizableArray<PartialCounts::Word>& words = partial[t][p].words;
+                for (size_t i = 0; i < words.size(); ++i) {
+                    merged.add(words[i].word, words[i].count, words[i].first);
+                }
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    vector<const PartialCounts::Word*> order;
+    for (unsigned p = 0; p < threads; ++p) {
+        const ResizableArray<PartialCounts::Word>& words = partial[0][p].words;
+        for (size_t i = 0; i < words.size(); ++i) order.push_back(&words[i]);
+    }
+    sort(order.begin(), order.end(), [](const PartialCounts::Word* a, const PartialCounts::Word* b) {
+        return a->first < b->first;
+    });
+
+    ResizableArray<pair<string,int>> freq_list;
+    for (const PartialCounts::Word* w : order) freq_list.push_back(make_pair(w->word, w->count));
+    return freq_list;
+}
+
+// The intern pass of main() on `threads` threads: each interns its piece
+// into a pool of its own and counts by local id; the pools are then
+// interned into words in piece order, which hands out ids in the same
+// first-occurrence order as one pass would. Each thread then rewrites its
+// tokens to those ids and indexes them from where its piece starts, and
+// the piece indexes are joined partitioned by word id (InvertedIndex::join).
+//
+// The vocabulary merge is the one serial step: ids have to be dense and in
+// first-occurrence order across pieces, and the pool has a single writer.
+// It's per distinct word of each piece, not per token. words, tokens,
+// freq_list and index must start empty. threads == 0 is taken as 1.
+inline void intern_tokens_parallel(string_view text, unsigned threads, StringPool& words,
+                                   ResizableArray<uint32_t>& tokens,
+                                   ResizableArray<pair<uint32_t,int>>& freq_list, InvertedIndex& index) {
+    assert(words.size() == 0 && tokens.size() == 0 && freq_list.size() == 0 && index.token_count() == 0);
+    if (threads == 0) threads = 1;
+    vector<string_view> pieces = split_at_token_boundaries(text, threads);
+    vector<StringPool> pools(threads);
+    vector<ResizableArray<uint32_t>> ids(threads);
+    vector<ResizableArray<int>> counts(threads);
+
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for_each_token_simd(pieces[t], [&](string_view w) {
+                uint32_t id = pools[t].intern(w);
+                ids[t].push_back(id);
+                if (id == counts[t].size()) counts[t].push_back(0);
+                counts[t][id]++;
+            });
+        });
+    }
+    for (auto& w : workers) w.join();
+    workers.clear();
+
+    // local id -> pool id, per piece
+    vector<ResizableArray<uint32_t>> remap(threads);
+    for (unsigned t = 0; t < threads; ++t) {
+        for (uint32_t local = 0; local < pools[t].size(); ++local) {
+            uint32_t id = words.intern(pools[t].view(local));
+            if (id == freq_list.size()) freq_list.push_back(make_pair(id, 0));
+            freq_list[id].second += counts[t][local];
+            remap[t].push_back(id);
+        }
+    }
+
+    vector<InvertedIndex> parts;
+    size_t skipped = 0;
+    for (unsigned t = 0; t < threads; ++t) {
+        parts.push_back(InvertedIndex(skipped));
+        skipped += ids[t].size();
+    }
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (size_t i = 0; i < ids[t].size(); ++i) {
+                ids[t][i] = remap[t][ids[t][i]];
+                parts[t].add(ids[t][i]);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    index = InvertedIndex::join(parts, threads);
+
+    tokens.reserve(skipped);
+    for (unsigned t = 0; t < threads; ++t) {
+        for (size_t i = 0; i < ids[t].size(); ++i) tokens.push_back(ids[t][i]);
+    }
+}
+
+#endif // PARALLEL_COUNTER_H
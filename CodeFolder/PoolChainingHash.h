@@ -0,0 +1,94 @@
+#ifndef POOL_CHAINING_HASH_H
+#define POOL_CHAINING_HASH_H
+
+#include "HashTable.h"
+#include "HashFunctions.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>  // for size_t
+#include <cassert>
+#include <memory>
+
+using namespace std;
+
+// Separate chaining without a heap node per key. All entries live in one
+// contiguous pool and chains are linked by 32-bit pool indices, so the pool
+// only reallocates when it doubles and a chain walk touches one array
+// instead of nodes scattered across the heap. Erasing moves the last node
+// into the hole, so the pool stays dense (and stops being in insertion
+// order once anything has been erased). The pool and the bucket heads come
+// from Alloc, rebound as needed.
+template<typename Key, typename Value, typename Hasher = WyHash,
+         typename Alloc = std::allocator<pair<Key,Value>>>
+class PoolChainingHash : public HashTable<Key,Value> {
+public:
+    explicit PoolChainingHash(size_t table_size, const Hasher& hf = Hasher(), const Alloc& alloc = Alloc())
+      : hsize(table_size), heads(table_size, NIL, HeadAlloc(alloc)), pool(NodeAlloc(alloc)), hasher(hf) {}
+    ~PoolChainingHash() override = default;
+
+    void insert(const Key& key, const Value& value) override {
+        find_or_insert(key, value) = value;    // overwrite existing count
+    }
+
+    Value& find_or_insert(const Key& key, const Value& initial) override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        for (uint32_t n = heads[idx]; n != NIL; n = pool[n].next) {
+            if (pool[n].key == key) return pool[n].value;
+        }
+        assert(pool.size() < NIL && "node pool is full");
+        pool.push_back(Node{key, initial, heads[idx]});
+        heads[idx] = static_cast<uint32_t>(pool.size() - 1);
+        return pool.back().value;
+    }
+
+    bool find(const Key& key, Value& value_out) const override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        for (uint32_t n = heads[idx]; n != NIL; n = pool[n].next) {
+            if (pool[n].key == key) {
+                value_out = pool[n].value;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool erase(const Key& key) override {
+        uint32_t* link = &heads[bucket_index(hasher(key), hsize)];
+        while (*link != NIL && !(pool[*link].key == key)) link = &pool[*link].next;
+        if (*link == NIL) return false;
+        uint32_t hole = *link;
+        *link = pool[hole].next;
+
+        uint32_t last = static_cast<uint32_t>(pool.size() - 1);
+        if (hole != last) {
+            // repoint whatever links to the last node, then move it down
+            uint32_t* to_last = &heads[bucket_index(hasher(pool[last].key), hsize)];
+            while (*to_last != last) to_last = &pool[*to_last].next;
+            *to_last = hole;
+            pool[hole] = move(pool[last]);
+        }
+        pool.pop_back();
+        return true;
+    }
+
+    size_t size() const override { return pool.size(); }
+
+    double load_factor() const override {
+        return static_cast<double>(pool.size()) / hsize;
+    }
+
+    void reserve(size_t entries) { pool.reserve(entries); }
+
+private:
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+    struct Node { Key key; Value value; uint32_t next; };
+    typedef typename allocator_traits<Alloc>::template rebind_alloc<uint32_t> HeadAlloc;
+    typedef typename allocator_traits<Alloc>::template rebind_alloc<Node> NodeAlloc;
+
+    size_t hsize;
+    vector<uint32_t, HeadAlloc> heads;
+    vector<Node, NodeAlloc> pool;
+    Hasher hasher;
+};
+
+#endif // POOL_CHAINING_HASH_H
@@ -2,80 +2,606 @@
 #define PROBING_HASH_H
 
 #include "HashTable.h"
+#include "HashFunctions.h"
+#include "TableStats.h"
 #include <vector>
 #include <cstdlib>  // for size_t, exit
 #include <cstring>
+#include <cstdint>
 #include <cassert>
+#include <utility>
+#include <algorithm>
 
 using namespace std;
-enum SlotState { EMPTY, OCCUPIED, DELETED };
+enum SlotState : uint8_t { EMPTY, OCCUPIED, DELETED };
 
-template<typename Key, typename Value>
+// What insert does once load_factor() reaches max_load:
+//  GROW_REHASH      - rehash everything into a table about twice the size
+//  GROW_INCREMENTAL - same new table, but move a few old slots per insert
+//                     so no single insert pays for the whole migration
+//  GROW_NONE        - fixed size, asserts like the original table
+enum GrowthPolicy { GROW_REHASH, GROW_INCREMENTAL, GROW_NONE };
+
+// Where a key may sit, and so which slots a lookup looks at:
+//  PROBE_LINEAR    - home, home + 1, home + 2, ...
+//  PROBE_QUADRATIC - home, home + 1, home + 3, home + 6, ... (triangular
+//                    steps), which breaks up the runs linear probing builds
+//  PROBE_DOUBLE    - home, home + s, home + 2s, ... with the step s taken
+//                    from a second hash, so keys sharing a home part at once
+//  PROBE_HOPSCOTCH - within HOP_RANGE slots of home. Each home slot keeps a
+//                    bitmap of which of those hold its keys, and an insert
+//                    moves other keys along to open up a slot in range.
+//  PROBE_CUCKOO    - in one of two windows of CUCKOO_WAYS slots picked by
+//                    two hashes; an insert with both full evicts a key to
+//                    its other window, so a lookup never looks at more than
+//                    2 * CUCKOO_WAYS slots
+// Hopscotch and cuckoo leave no tombstones. When an insert can't find room
+// in reach (those two, or a quadratic or double hashing sequence that
+// doesn't visit every slot) the table is rebuilt at about twice the size.
+// Keys that still don't fit, such as more keys sharing one hash than a
+// neighbourhood holds, wait in a small stash that lookups check last.
+enum ProbeScheme { PROBE_LINEAR, PROBE_QUADRATIC, PROBE_DOUBLE, PROBE_HOPSCOTCH, PROBE_CUCKOO };
+
+inline const char* probe_scheme_name(ProbeScheme scheme) {
+    const char* names[] = { "linear probing", "quadratic probing", "double hashing", "hopscotch", "cuckoo" };
+    return names[scheme];
+}
+
+template<typename Key, typename Value, typename Hasher = WyHash>
 class ProbingHash : public HashTable<Key,Value> {
 public:
-    typedef size_t (*HashFunc)(const Key&, size_t);
-    ProbingHash(size_t table_size, double max_load, HashFunc hf = nullptr)
-      : hsize(table_size), table(table_size), count(0), max_load(max_load), hash_func(hf ? hf : default_string_hash) {
-        for (auto& e : table) e.state = EMPTY;
-    }
+    ProbingHash(size_t table_size, double max_load, GrowthPolicy growth = GROW_REHASH,
+                ProbeScheme scheme = PROBE_LINEAR, const Hasher& hf = Hasher())
+      : hsize(table_size), table(table_size), count(0), deleted(0), max_load(max_load), hasher(hf),
+        scheme(scheme), growth(growth), old_size(0), old_count(0), migrate_pos(0),
+        kick_rng(0x9E3779B97F4A7C15ULL) {}
     ~ProbingHash() override = default;
 
     void insert(const Key& key, const Value& value) override {
-        size_t idx = hash_func(key, hsize);
-        size_t start = idx;
-
-        // 1) Upsert: if key exists, overwrite value
-        do {
-            if (table[idx].state == OCCUPIED && table[idx].key == key) {
-                table[idx].value = value;
-                return;
-            }
-            if (table[idx].state == EMPTY) break;
-            idx = (idx + 1) % hsize;
-        } while (idx != start);
+        find_or_insert(key, value) = value;
+    }
+
+    Value& find_or_insert(const Key& key, const Value& initial) override {
+        return find_or_insert<Key>(key, initial);
+    }
 
-        // 2)  ensure below load factor
-        assert(load_factor() < max_load && "Load factor exceeded");
+    // Heterogeneous version: any K the hasher and Key == K accept, e.g. a
+    // string_view into a mapped file. A Key is only built when K is new.
+    template<typename K>
+    Value& find_or_insert(const K& key, const Value& initial) {
+        return find_or_insert_hashed(key, hasher(key), initial);
+    }
 
-        // find next available slot 
-        while (table[idx].state == OCCUPIED) {
-            idx = (idx + 1) % hsize;
+    // Batched insert / increment / find; see HASH_BATCH. Without deltas
+    // every key is incremented by one. find_batch returns the hits, and
+    // sets found[i] if found isn't null; misses leave values_out[i] alone.
+    void insert_batch(const Key* keys, const Value* values, size_t n) {
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            find_or_insert_hashed(keys[i], h, values[i]) = values[i];
+        });
+    }
+
+    void increment_batch(const Key* keys, size_t n, const Value* deltas = nullptr) {
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            find_or_insert_hashed(keys[i], h, Value()) += deltas ? deltas[i] : Value(1);
+        });
+    }
+
+    size_t find_batch(const Key* keys, size_t n, Value* values_out, bool* found = nullptr) const {
+        size_t hits = 0;
+        in_batches(keys, n, prefetcher(), [&](size_t i, uint64_t h) {
+            size_t probes = 0;
+            const Entry* e = lookup(keys[i], h, probes);
+            if (e) {
+                lookups.hit(probes);
+                values_out[i] = e->value;
+            } else {
+                lookups.miss(probes);
+            }
+            if (found) found[i] = e != nullptr;
+            hits += e != nullptr;
+        });
+        return hits;
+    }
+
+    // The slot becomes a tombstone so keys further along its probe run stay
+    // reachable. Once tombstones are TOMBSTONE_SHARE of the slots the table
+    // is compacted, or misses would keep walking over them.
+    bool erase(const Key& key) override {
+        uint64_t h = hasher(key);
+        size_t probes = 0;
+        Entry* e = locate(table, hsize, key, h, probes);
+        SlotState left = DELETED;
+        if (e) {
+            count--;
+            if (!bounded_lookup()) {
+                deleted++;
+            } else {
+                // their lookups don't stop at empty slots
+                left = EMPTY;
+                if (scheme == PROBE_HOPSCOTCH) {
+                    size_t idx = e - table.data(), home = bucket_index(h, hsize);
+                    table[home].hop &= ~(1u << (idx + hsize - home) % hsize);
+                }
+            }
+        } else if (migrating() && (e = locate(old_table, old_size, key, h, probes))) {
+            // old tombstones go away with the old table
+            old_count--;
+        } else if (!stash.empty() && (e = in_stash(key, probes))) {
+            count--;
+            swap(*e, stash.back());
+            stash.pop_back();
+            return true;
+        } else {
+            return false;
         }
-        table[idx] = {key, value, OCCUPIED};
-        count++;
+        e->state = left;
+        e->key = Key();
+        e->value = Value();
+        if (deleted > hsize * TOMBSTONE_SHARE) compact();
+        return true;
     }
 
     bool find(const Key& key, Value& value_out) const override {
-        size_t idx = hash_func(key, hsize);
-        size_t start = idx;
-        do {
-            if (table[idx].state == EMPTY) return false;
-            if (table[idx].state == OCCUPIED && table[idx].key == key) {
-                value_out = table[idx].value;
-                return true;
-            }
-            idx = (idx + 1) % hsize;
-        } while (idx != start);
-        return false;
+        size_t probes = 0;
+        const Entry* e = lookup(key, hasher(key), probes);
+        if (!e) {
+            lookups.miss(probes);
+            return false;
+        }
+        lookups.hit(probes);
+        value_out = e->value;
+        return true;
+    }
+
+    size_t size() const override { return count + old_count; }
+    double load_factor() const override { return static_cast<double>(size()) / hsize; }
+
+    size_t capacity() const { return hsize; }
+    bool migrating() const { return old_size != 0; }
+    ProbeScheme probe_scheme() const { return scheme; }
+
+    // slots a find(key) looks at, hit or miss; needs no HASH_STATS build
+    template<typename K>
+    size_t probes_for(const K& key) const {
+        size_t probes = 0;
+        lookup(key, hasher(key), probes);
+        return probes;
+    }
+
+    // fn(key, value) for every entry, in slot order (entries still waiting
+    // in the old table of an incremental rehash, then stashed ones, come last)
+    template<typename Fn>
+    void for_each(Fn fn) const {
+        for (const Entry& e : table) {
+            if (e.state == OCCUPIED) fn(e.key, e.value);
+        }
+        for (const Entry& e : old_table) {
+            if (e.state == OCCUPIED) fn(e.key, e.value);
+        }
+        for (const Entry& e : stash) fn(e.key, e.value);
     }
 
-    size_t size() const override { return count; }
-    double load_factor() const override { return static_cast<double>(count) / hsize; }
-    void set_hash_function(HashFunc hf) { assert(hf); hash_func = hf; }
+    TableStats stats() const {
+        TableStats s;
+        s.layout = probe_scheme_name(scheme);
+        s.size = size();
+        s.slots = hsize;
+        s.tombstones = 0;
+        probe_lengths(table, hsize, s);
+        probe_lengths(old_table, old_size, s);
+        for (const Entry& e : stash) {
+            size_t probes = 0;
+            lookup(e.key, hasher(e.key), probes);
+            add_probe_length(s, probes);
+        }
+        s.bytes = sizeof(*this) + (table.capacity() + old_table.capacity() + stash.capacity()) * sizeof(Entry);
+        add_lookup_counts(s, lookups);
+        return s;
+    }
 
 private:
-    struct Entry { Key key; Value value; SlotState state; };
+    // hop is the hopscotch bitmap of the slot as a home: bit i is set when
+    // slot + i holds one of its keys. It shares a word with the state, so a
+    // slot is no bigger than before; value-initialized slots are EMPTY with
+    // no bits set.
+    static constexpr unsigned HOP_BITS = 30;
+    struct Entry { Key key; Value value; SlotState state : 2; uint32_t hop : HOP_BITS; };
     size_t hsize;
     vector<Entry> table;
     size_t count;
+    size_t deleted;     // tombstones in table (not old_table)
     double max_load;
-    HashFunc hash_func;
+    Hasher hasher;
+    ProbeScheme scheme;
+
+    // previous table while an incremental rehash is in progress
+    GrowthPolicy growth;
+    vector<Entry> old_table;
+    size_t old_size;
+    size_t old_count;
+    size_t migrate_pos;
+    uint64_t kick_rng;  // xorshift state for picking cuckoo victims
+    vector<Entry> stash;    // keys no slot in reach could take; counted in count
+    mutable LookupCounters lookups;
+
+    // old slots moved per insert; with a table at least twice as big the
+    // migration finishes before the new table fills for any max_load above
+    // ~0.25, and grow() drains whatever is left otherwise
+    static constexpr size_t REHASH_STEP = 4;
+    static constexpr double TOMBSTONE_SHARE = 0.25;
+    static constexpr size_t HOP_RANGE = HOP_BITS;   // neighbourhood, home included
+    static constexpr size_t CUCKOO_WAYS = 4;
+    static constexpr size_t MAX_KICKS = 500;
+
+    // hopscotch and cuckoo: a key can only be in a few known slots
+    bool bounded_lookup() const { return scheme == PROBE_HOPSCOTCH || scheme == PROBE_CUCKOO; }
+
+    // a second index from the same hash, for double hashing's step and
+    // cuckoo's other window
+    static size_t second_index(uint64_t h, size_t sz) {
+        uint64_t m = hash_mix(h);
+        return fast_range((m ^ (m >> 32)) * 0xBF58476D1CE4E5B9ULL, sz);
+    }
+
+    // step between the slots of a probe sequence; in [1, sz) for double
+    // hashing, which reaches every slot when sz is prime
+    size_t stride_of(uint64_t h, size_t sz) const {
+        return scheme == PROBE_DOUBLE && sz > 1 ? 1 + second_index(h, sz - 1) : 1;
+    }
+
+    size_t next_slot(size_t idx, size_t step, size_t stride, size_t sz) const {
+        return (idx + (scheme == PROBE_QUADRATIC ? step : stride)) % sz;
+    }
+
+    // h is hasher(key); probes is bumped once per slot looked at; tomb, if
+    // given, gets the first tombstone before the key or the empty slot that
+    // ends the search
+    template<typename K>
+    Entry* locate(vector<Entry>& t, size_t sz, const K& key, uint64_t h, size_t& probes, size_t* tomb = nullptr) {
+        return const_cast<Entry*>(static_cast<const ProbingHash*>(this)->locate(t, sz, key, h, probes, tomb));
+    }
+
+    template<typename K>
+    const Entry* locate(const vector<Entry>& t, size_t sz, const K& key, uint64_t h, size_t& probes,
+                        size_t* tomb = nullptr) const {
+        size_t idx = bucket_index(h, sz);
+        if (scheme == PROBE_HOPSCOTCH) {
+            probes++;  // the home slot, for its bitmap
+            for (unsigned bits = t[idx].hop; bits; bits &= bits - 1) {
+                size_t off = __builtin_ctz(bits);
+                if (off) probes++;
+                const Entry& e = t[(idx + off) % sz];
+                if (e.state == OCCUPIED && e.key == key) return &e;
+            }
+            return nullptr;
+        }
+        if (scheme == PROBE_CUCKOO) {
+            size_t windows[2] = { idx, second_index(h, sz) };
+            for (size_t w = 0; w < (windows[0] == windows[1] ? 1 : 2); ++w) {
+                for (size_t i = 0; i < CUCKOO_WAYS; ++i) {
+                    probes++;
+                    const Entry& e = t[(windows[w] + i) % sz];
+                    if (e.state == OCCUPIED && e.key == key) return &e;
+                }
+            }
+            return nullptr;
+        }
+        size_t stride = stride_of(h, sz);
+        for (size_t step = 1; step <= sz; ++step) {
+            probes++;
+            if (t[idx].state == EMPTY) return nullptr;
+            if (t[idx].state == OCCUPIED && t[idx].key == key) return &t[idx];
+            if (tomb && t[idx].state == DELETED && *tomb == sz) *tomb = idx;
+            idx = next_slot(idx, step, stride, sz);
+        }
+        return nullptr;
+    }
+
+    // find_or_insert with the key already hashed
+    template<typename K>
+    Value& find_or_insert_hashed(const K& key, uint64_t h, const Value& initial) {
+        // keys that haven't been migrated yet are used where they are
+        if (migrating()) migrate_step();
+        size_t probes = 0;
+        if (migrating()) {
+            Entry* old = locate(old_table, old_size, key, h, probes);
+            if (old) {
+                lookups.hit(probes);
+                return old->value;
+            }
+        }
+
+        // 1) Upsert: if key exists, hand back its value; remember the
+        //    first tombstone on the way, a new key goes there
+        size_t tomb = hsize;
+        Entry* e = locate(table, hsize, key, h, probes, &tomb);
+        if (!e && !stash.empty()) e = in_stash(key, probes);
+        if (e) {
+            lookups.hit(probes);
+            return e->value;
+        }
+        lookups.miss(probes);
+
+        if (tomb != hsize) return fill(tomb, Key(key), Value(initial)).value;
+
+        // 2) make room before going over the load factor; tombstones take up
+        //    probe room like keys do, so they count here
+        if (static_cast<double>(size() + deleted) / hsize >= max_load) {
+            if (static_cast<double>(size()) / hsize < max_load / 2) {
+                compact();
+            } else {
+                assert(growth != GROW_NONE && "Load factor exceeded");
+                grow();
+            }
+        }
+
+        // hopscotch and cuckoo may have moved it on again
+        if ((e = place(Key(key), Value(initial)))) return e->value;
+        probes = 0;
+        return const_cast<Entry*>(lookup(key, h, probes))->value;
+    }
 
-    // Horners rule
-    static size_t default_string_hash(const string& s, size_t mod) {
-        size_t h = 0;
-        for (char c : s) h = (h * 31 + static_cast<unsigned char>(c)) % mod;
-        return h;
+    // Hashes a group and prefetches each key's home slot, and for cuckoo
+    // its other window too; probes from there on are mostly in the same line
+    // or the next.
+    auto prefetcher() const {
+        return [this](const Key* keys, size_t m, uint64_t* h) {
+            for (size_t i = 0; i < m; ++i) {
+                h[i] = hasher(keys[i]);
+                __builtin_prefetch(&table[bucket_index(h[i], hsize)]);
+                if (scheme == PROBE_CUCKOO) __builtin_prefetch(&table[second_index(h[i], hsize)]);
+            }
+        };
+    }
+
+    // key's entry wherever it is: table, the old table mid-rehash, or the stash
+    template<typename K>
+    const Entry* lookup(const K& key, uint64_t h, size_t& probes) const {
+        const Entry* e = locate(table, hsize, key, h, probes);
+        if (!e && migrating()) e = locate(old_table, old_size, key, h, probes);
+        if (!e && !stash.empty()) e = in_stash(key, probes);
+        return e;
+    }
+
+    template<typename K>
+    Entry* in_stash(const K& key, size_t& probes) {
+        for (Entry& e : stash) {
+            probes++;
+            if (e.key == key) return &e;
+        }
+        return nullptr;
+    }
+
+    template<typename K>
+    const Entry* in_stash(const K& key, size_t& probes) const {
+        return const_cast<ProbingHash*>(this)->in_stash(key, probes);
+    }
+
+    // Put a key known to be absent into the table. Null if hopscotch or
+    // cuckoo may have moved it on again, or if there was no room in reach
+    // and the table was rebuilt around it.
+    Entry* place(Key&& key, Value&& value) {
+        size_t idx = try_place(key, value);
+        if (idx == hsize) {
+            overflow(move(key), move(value));
+            return nullptr;
+        }
+        return scheme == PROBE_CUCKOO ? nullptr : &table[idx];
+    }
+
+    // The slot key went to, or hsize if there's no room in reach; a failed
+    // cuckoo insert leaves key and value holding the last key it evicted.
+    size_t try_place(Key& key, Value& value) {
+        uint64_t h = hasher(key);
+        if (scheme == PROBE_HOPSCOTCH) return hop_place(h, key, value);
+        if (scheme == PROBE_CUCKOO) return cuckoo_place(h, key, value);
+        // the first free slot of its probe run
+        size_t idx = bucket_index(h, hsize), stride = stride_of(h, hsize);
+        for (size_t step = 1; step <= hsize; ++step) {
+            if (table[idx].state != OCCUPIED) {
+                fill(idx, move(key), move(value));
+                return idx;
+            }
+            idx = next_slot(idx, step, stride, hsize);
+        }
+        return hsize;
+    }
+
+    // the first free slot after home, hopped back until it's in range
+    size_t hop_place(uint64_t h, Key& key, Value& value) {
+        size_t home = bucket_index(h, hsize), idx = home, dist = 0;
+        while (table[idx].state == OCCUPIED) {
+            if (++dist == hsize) return hsize;
+            idx = (idx + 1) % hsize;
+        }
+        while (dist >= HOP_RANGE) {
+            idx = hop_closer(idx);
+            if (idx == hsize) return hsize;
+            dist = (idx + hsize - home) % hsize;
+        }
+        table[home].hop |= 1u << dist;
+        fill(idx, move(key), move(value));
+        return idx;
+    }
+
+    // Move a key from the HOP_RANGE - 1 slots before the hole into it,
+    // one that stays in range of its own home, the earliest found first;
+    // the slot that frees up, or hsize if no key can move
+    size_t hop_closer(size_t hole) {
+        for (size_t back = HOP_RANGE - 1; back > 0; --back) {
+            size_t home = (hole + hsize - back) % hsize;
+            unsigned bits = table[home].hop;
+            if (!bits || static_cast<size_t>(__builtin_ctz(bits)) >= back) continue;
+            size_t off = __builtin_ctz(bits), from = (home + off) % hsize;
+            table[hole].key = move(table[from].key);
+            table[hole].value = move(table[from].value);
+            table[hole].state = OCCUPIED;
+            table[from].state = EMPTY;
+            table[home].hop = ((bits & ~(1u << off)) | (1u << back));
+            return from;
+        }
+        return hsize;
+    }
+
+    // a free slot in either window, else evict a random key from one and
+    // carry that one to its own windows instead
+    size_t cuckoo_place(uint64_t h, Key& key, Value& value) {
+        for (size_t kick = 0;; ++kick) {
+            size_t windows[2] = { bucket_index(h, hsize), second_index(h, hsize) };
+            for (size_t w = 0; w < 2; ++w) {
+                for (size_t i = 0; i < CUCKOO_WAYS; ++i) {
+                    size_t idx = (windows[w] + i) % hsize;
+                    if (table[idx].state != OCCUPIED) {
+                        fill(idx, move(key), move(value));
+                        return idx;
+                    }
+                }
+            }
+            if (kick == MAX_KICKS) return hsize;
+            kick_rng ^= kick_rng << 13;
+            kick_rng ^= kick_rng >> 7;
+            kick_rng ^= kick_rng << 17;
+            size_t victim = (windows[kick_rng & 1] + (kick_rng >> 1) % CUCKOO_WAYS) % hsize;
+            swap(key, table[victim].key);
+            swap(value, table[victim].value);
+            h = hasher(key);
+        }
+    }
+
+    // No room in reach for key, below max_load. A mostly empty table
+    // wouldn't do better bigger, so key goes to the stash; otherwise
+    // everything is rebuilt at about twice the size, and whatever still
+    // doesn't fit is stashed.
+    void overflow(Key&& key, Value&& value) {
+        if (size() < hsize / 4) {
+            stash_entry(move(key), move(value));
+            return;
+        }
+        assert(growth != GROW_NONE && "No free slot in reach");
+        lookups.resized();
+        vector<Entry> homeless;
+        homeless.push_back(Entry{move(key), move(value), EMPTY, 0});
+        for (Entry& e : table) {
+            if (e.state == OCCUPIED) homeless.push_back(Entry{move(e.key), move(e.value), EMPTY, 0});
+        }
+        for (Entry& e : old_table) {
+            if (e.state == OCCUPIED) homeless.push_back(Entry{move(e.key), move(e.value), EMPTY, 0});
+        }
+        for (Entry& e : stash) homeless.push_back(move(e));
+        hsize = next_prime(hsize * 2);
+        table.assign(hsize, Entry());
+        vector<Entry>().swap(old_table);
+        stash.clear();
+        old_size = old_count = migrate_pos = 0;
+        count = deleted = 0;
+        for (Entry& e : homeless) {
+            if (try_place(e.key, e.value) == hsize) stash_entry(move(e.key), move(e.value));
+        }
+    }
+
+    void stash_entry(Key&& key, Value&& value) {
+        stash.push_back(Entry{move(key), move(value), OCCUPIED, 0});
+        count++;
+    }
+
+    // give stashed keys another go once the table has been rebuilt
+    void unstash() {
+        vector<Entry> waiting;
+        waiting.swap(stash);
+        count -= waiting.size();
+        for (Entry& e : waiting) place(move(e.key), move(e.value));
+    }
+
+    Entry& fill(size_t idx, Key&& key, Value&& value) {
+        if (table[idx].state == DELETED) deleted--;
+        table[idx].key = move(key);
+        table[idx].value = move(value);
+        table[idx].state = OCCUPIED;
+        count++;
+        return table[idx];
+    }
+
+    void grow() {
+        if (migrating()) finish_migration();
+        lookups.resized();
+
+        vector<Entry> prev(next_prime(hsize * 2));
+        prev.swap(table);
+        old_table = move(prev);
+        old_size = hsize;
+        old_count = count;
+        hsize = table.size();
+        count = 0;
+        deleted = 0;
+        migrate_pos = 0;
+
+        if (growth != GROW_INCREMENTAL) finish_migration();
+        unstash();
+    }
+
+    // rebuild at the same size without the tombstones
+    void compact() {
+        if (migrating()) finish_migration();
+        vector<Entry> prev(hsize);
+        prev.swap(table);
+        count = 0;
+        deleted = 0;
+        for (Entry& e : prev) {
+            if (e.state == OCCUPIED) place(move(e.key), move(e.value));
+        }
+        unstash();
+    }
+
+    void migrate_step() {
+        size_t stop = min(old_size, migrate_pos + REHASH_STEP);
+        for (; migrate_pos < stop; ++migrate_pos) {
+            Entry& e = old_table[migrate_pos];
+            if (e.state != OCCUPIED) continue;
+            // leave a tombstone so later old entries stay reachable
+            e.state = DELETED;
+            old_count--;
+            place(move(e.key), move(e.value));
+            // an overflow rebuild took the rest of the old table with it
+            if (!migrating()) return;
+        }
+        if (migrate_pos == old_size) {
+            vector<Entry>().swap(old_table);
+            old_size = 0;
+        }
+    }
+
+    void finish_migration() {
+        while (migrating()) migrate_step();
+    }
+
+    // histogram of the probes each key takes to reach, and the tombstones
+    // left in t
+    void probe_lengths(const vector<Entry>& t, size_t sz, TableStats& s) const {
+        for (size_t i = 0; i < sz; ++i) {
+            if (t[i].state == DELETED) s.tombstones++;
+            if (t[i].state != OCCUPIED) continue;
+            size_t probes = 0;
+            locate(t, sz, t[i].key, hasher(t[i].key), probes);
+            add_probe_length(s, probes);
+        }
+    }
+
+    static void add_probe_length(TableStats& s, size_t probes) {
+        if (s.histogram.size() < probes) s.histogram.resize(probes, 0);
+        s.histogram[probes - 1]++;
+    }
+
+    static size_t next_prime(size_t n) {
+        if (n < 3) return 3;
+        if (n % 2 == 0) n++;
+        for (;; n += 2) {
+            bool prime = true;
+            for (size_t d = 3; d * d <= n; d += 2) {
+                if (n % d == 0) { prime = false; break; }
+            }
+            if (prime) return n;
+        }
     }
 };
 
@@ -0,0 +1,158 @@
+#ifndef SECTIONS_H
+#define SECTIONS_H
+
+#include "WordCounter.h"
+#include "FinalAssignment.h"
+#include "SimdText.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+
+using namespace std;
+
+// A book split at its chapter headings, with one WordCounter per section.
+//
+// Headings are found in a pre-pass over line starts: a heading line is an
+// optional "ADVENTURE", a roman numeral and a period, then a title in
+// capitals ("   I. A Scandal in Bohemia", "ADVENTURE II. THE RED-HEADED
+// LEAGUE", "VII. THE ADVENTURE OF THE BLUE CARBUNCLE"). Section 0 is
+// whatever comes before the first heading; heading lines themselves
+// belong to no section.
+//
+// The sections are then counted by a small pool of workers that each take
+// the next uncounted section until none are left, so one long chapter
+// doesn't hold up the short ones. Queries over a range of sections merge
+// or look up the per-section counters only when they're asked.
+
+struct Section {
+    string title;       // heading line, empty for section 0
+    size_t begin, end;  // byte range of the text under the heading
+};
+
+// the heading on line (trimmed) if it is one
+inline bool section_heading(string_view line, string_view& title) {
+    size_t i = 0;
+    while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+    string_view rest = line.substr(i);
+    if (rest.substr(0, 10) == "ADVENTURE ") rest.remove_prefix(10);
+    size_t n = 0;
+    while (n < rest.size() && (rest[n] == 'I' || rest[n] == 'V' || rest[n] == 'X')) ++n;
+    if (n == 0 || n + 2 >= rest.size() || rest[n] != '.' || rest[n + 1] != ' ') return false;
+    if (rest[n + 2] < 'A' || rest[n + 2] > 'Z') return false;
+    size_t end = line.size();
+    while (end > i && (line[end - 1] == '\r' || line[end - 1] == ' ')) --end;
+    title = line.substr(i, end - i);
+    return true;
+}
+
+inline ResizableArray<Section> find_sections(string_view text) {
+    ResizableArray<Section> sections;
+    sections.push_back(Section{string(), 0, text.size()});
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const char* nl = static_cast<const char*>(memchr(text.data() + pos, '\n', text.size() - pos));
+        size_t eol = nl ? nl - text.data() : text.size();
+        string_view title;
+        if (section_heading(text.substr(pos, eol - pos), title)) {
+            sections.back().end = pos;
+            sections.push_back(Section{string(title), min(eol + 1, text.size()), text.size()});
+        }
+        pos = eol + 1;
+    }
+    return sections;
+}
+
+class SectionCounts {
+public:
+    // threads == 0 is taken as 1, which counts everything on this thread
+    SectionCounts(string_view text, unsigned threads)
+      : sections(find_sections(text)), counters(sections.size()) {
+        atomic<size_t> next(0);
+        auto work = [&] {
+            for (size_t s; (s = next++) < sections.size();) {
+                string_view part = text.substr(sections[s].begin, sections[s].end - sections[s].begin);
+                for_each_token_simd(part, [&](string_view w) { counters[s].add(w); });
+            }
+        };
+        vector<thread> pool;
+        size_t workers = min<size_t>(max(1u, threads), sections.size());
+        for (size_t t = 1; t < workers; ++t) pool.emplace_back(work);
+        work();
+        for (auto& t : pool) t.join();
+    }
+
+    // sections, counting section 0
+    size_t size() const { return sections.size(); }
+    const Section& section(size_t s) const { return sections[s]; }
+    const WordCounter& counts(size_t s) const { return counters[s]; }
+
+    size_t total_words(size_t first, size_t last) const {
+        size_t total = 0;
+        for (size_t s = first; s <= last; ++s) total += counters[s].total_words();
+        return total;
+    }
+
+    // count of word over sections first..last, straight from each section
+    int count(const string& word, size_t first, size_t last) const {
+        int n = 0;
+        for (size_t s = first; s <= last; ++s) n += counters[s].count(word);
+        return n;
+    }
+
+    // sections first..last folded into one counter. Folding goes in section
+    // order, so the list stays in first-occurrence order across the range.
+    WordCounter merged(size_t first, size_t last) const {
+        if (first == last) return counters[first];
+        size_t upper_bound = 0;
+        for (size_t s = first; s <= last; ++s) upper_bound += counters[s].unique_words();
+        WordCounter all(upper_bound);
+        for (size_t s = first; s <= last; ++s) {
+            const ResizableArray<pair<string,int>>& freq = counters[s].counts();
+            for (size_t i = 0; i < freq.size(); ++i) all.add(freq[i].first, freq[i].second);
+        }
+        return all;
+    }
+
+private:
+    ResizableArray<Section> sections;
+    vector<WordCounter> counters;
+};
+
+// one word's frequency in two ranges of sections; rates are per 10,000
+// words of the range
+struct SectionDiff {
+    string word;
+    int count_a, count_b;
+    double rate_a, rate_b;
+};
+
+// The k words that make up a bigger share of range A than of range B,
+// biggest gap first (ties to the word A saw first). Only A is merged; B is
+// asked per section for the words A has.
+inline ResizableArray<SectionDiff> over_represented(const SectionCounts& sc, size_t a_first, size_t a_last,
+                                                    size_t b_first, size_t b_last, size_t k) {
+    WordCounter a = sc.merged(a_first, a_last);
+    double a_total = max<size_t>(1, sc.total_words(a_first, a_last));
+    double b_total = max<size_t>(1, sc.total_words(b_first, b_last));
+    vector<SectionDiff> diffs;
+    const ResizableArray<pair<string,int>>& freq = a.counts();
+    for (size_t i = 0; i < freq.size(); ++i) {
+        int b = sc.count(freq[i].first, b_first, b_last);
+        double rate_a = freq[i].second * 10000.0 / a_total, rate_b = b * 10000.0 / b_total;
+        if (rate_a > rate_b) diffs.push_back(SectionDiff{freq[i].first, freq[i].second, b, rate_a, rate_b});
+    }
+    // diffs are still in first-occurrence order, so a stable sort keeps ties that way
+    stable_sort(diffs.begin(), diffs.end(), [](const SectionDiff& x, const SectionDiff& y) {
+        return x.rate_a - x.rate_b > y.rate_a - y.rate_b;
+    });
+    ResizableArray<SectionDiff> result;
+    for (size_t i = 0; i < diffs.size() && i < k; ++i) result.push_back(diffs[i]);
+    return result;
+}
+
+#endif // SECTIONS_H
@@ -0,0 +1,198 @@
+#ifndef SIMD_TEXT_H
+#define SIMD_TEXT_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_TEXT_X86 1
+#endif
+
+using namespace std;
+
+// Vectorized versions of for_each_token and count_sentences. A kernel
+// classifies a block of bytes at a time into an ASCII alphanumeric bitmask
+// (bit i of masks[i / 64] for byte i) while writing a lowercased copy, then
+// token boundaries come from scanning the bitmask instead of the bytes.
+// Which kernel runs is picked once at runtime from what the CPU supports.
+// ASCII alphanumerics are exactly what isalnum accepts in the "C" locale
+// the program runs in, so the tokens match the scalar tokenizer.
+enum SimdLevel { SIMD_SCALAR, SIMD_SSE42, SIMD_AVX2 };
+
+inline const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SIMD_AVX2:  return "AVX2";
+        case SIMD_SSE42: return "SSE4.2";
+        default:         return "scalar";
+    }
+}
+
+inline SimdLevel best_simd_level() {
+#ifdef SIMD_TEXT_X86
+    static const SimdLevel level = __builtin_cpu_supports("avx2") ? SIMD_AVX2
+                                 : __builtin_cpu_supports("sse4.2") ? SIMD_SSE42
+                                 : SIMD_SCALAR;
+    return level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+inline bool is_ascii_letter(char c) { return static_cast<unsigned char>((c | 0x20) - 'a') < 26; }
+inline bool is_ascii_alnum(char c) { return is_ascii_letter(c) || static_cast<unsigned char>(c - '0') < 10; }
+
+inline void classify_lower_scalar(const char* src, char* dst, uint64_t* masks, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        char c = src[i];
+        dst[i] = is_ascii_letter(c) ? static_cast<char>(c | 0x20) : c;
+        if (i % 64 == 0) masks[i / 64] = 0;
+        if (is_ascii_alnum(c)) masks[i / 64] |= 1ULL << (i % 64);
+    }
+}
+
+inline size_t count_sentences_scalar(const char* p, size_t n) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) count += (p[i] == '.' || p[i] == '!' || p[i] == '?');
+    return count;
+}
+
+#ifdef SIMD_TEXT_X86
+// PCMPESTRM range mode: one instruction tests 16 bytes against 0-9 A-Z a-z
+__attribute__((target("sse4.2")))
+inline void classify_lower_sse42(const char* src, char* dst, uint64_t* masks, size_t n) {
+    const __m128i alnum_ranges = _mm_setr_epi8('0', '9', 'A', 'Z', 'a', 'z', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i upper_range = _mm_setr_epi8('A', 'Z', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const int flags = _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint64_t m = 0;
+        for (size_t k = 0; k < 64; k += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + k));
+            __m128i alnum = _mm_cmpestrm(alnum_ranges, 6, v, 16, flags | _SIDD_BIT_MASK);
+            __m128i upper = _mm_cmpestrm(upper_range, 2, v, 16, flags | _SIDD_UNIT_MASK);
+            v = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + k), v);
+            m |= static_cast<uint64_t>(_mm_cvtsi128_si32(alnum) & 0xFFFF) << k;
+        }
+        masks[i / 64] = m;
+    }
+    classify_lower_scalar(src + i, dst + i, masks + i / 64, n - i);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+inline size_t count_sentences_sse42(const char* p, size_t n) {
+    size_t count = 0, i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('.')),
+                                                _mm_cmpeq_epi8(v, _mm_set1_epi8('!'))),
+                                   _mm_cmpeq_epi8(v, _mm_set1_epi8('?')));
+        count += _mm_popcnt_u32(static_cast<unsigned>(_mm_movemask_epi8(hit)));
+    }
+    return count + count_sentences_scalar(p + i, n - i);
+}
+
+// (c | 0x20) - 'a' <= 25 unsigned is a letter, c - '0' <= 9 a digit;
+// min_epu8 + cmpeq is the unsigned <= AVX2 doesn't have
+__attribute__((target("avx2")))
+inline uint32_t classify_lower_avx2_32(const char* src, char* dst) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    __m256i case_bit = _mm256_set1_epi8(0x20);
+    __m256i la = _mm256_sub_epi8(_mm256_or_si256(v, case_bit), _mm256_set1_epi8('a'));
+    __m256i letter = _mm256_cmpeq_epi8(_mm256_min_epu8(la, _mm256_set1_epi8(25)), la);
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    __m256i digit = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_or_si256(v, _mm256_and_si256(letter, case_bit)));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(letter, digit)));
+}
+
+__attribute__((target("avx2")))
+inline void classify_lower_avx2(const char* src, char* dst, uint64_t* masks, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        uint64_t lo = classify_lower_avx2_32(src + i, dst + i);
+        uint64_t hi = classify_lower_avx2_32(src + i + 32, dst + i + 32);
+        masks[i / 64] = lo | (hi << 32);
+    }
+    classify_lower_scalar(src + i, dst + i, masks + i / 64, n - i);
+}
+
+__attribute__((target("avx2,popcnt")))
+inline size_t count_sentences_avx2(const char* p, size_t n) {
+    size_t count = 0, i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')),
+                                                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('!'))),
+                                      _mm256_cmpeq_epi8(v, _mm256_set1_epi8('?')));
+        count += _mm_popcnt_u32(static_cast<unsigned>(_mm256_movemask_epi8(hit)));
+    }
+    return count + count_sentences_scalar(p + i, n - i);
+}
+#endif
+
+inline void classify_lower(const char* src, char* dst, uint64_t* masks, size_t n, SimdLevel level) {
+#ifdef SIMD_TEXT_X86
+    if (level == SIMD_AVX2) return classify_lower_avx2(src, dst, masks, n);
+    if (level == SIMD_SSE42) return classify_lower_sse42(src, dst, masks, n);
+#endif
+    (void)level;
+    classify_lower_scalar(src, dst, masks, n);
+}
+
+inline size_t count_sentences_simd(string_view text, SimdLevel level = best_simd_level()) {
+#ifdef SIMD_TEXT_X86
+    if (level == SIMD_AVX2) return count_sentences_avx2(text.data(), text.size());
+    if (level == SIMD_SSE42) return count_sentences_sse42(text.data(), text.size());
+#endif
+    (void)level;
+    return count_sentences_scalar(text.data(), text.size());
+}
+
+// Same tokens as for_each_token. Text goes through in blocks that end on a
+// non-alphanumeric byte; every token is a view into the block's lowercased
+// copy, so no token is ever copied on its own. A view is only good until fn
+// returns.
+template<typename Fn>
+void for_each_token_simd(string_view text, Fn fn, SimdLevel level = best_simd_level()) {
+    const size_t BLOCK = 64 * 1024;
+    vector<char> lower;
+    vector<uint64_t> masks;
+    while (!text.empty()) {
+        size_t n = min(BLOCK, text.size());
+        while (n < text.size() && is_ascii_alnum(text[n])) ++n;
+        if (lower.size() < n) {
+            lower.resize(n);
+            masks.resize(n / 64 + 1);
+        }
+        classify_lower(text.data(), lower.data(), masks.data(), n, level);
+
+        // a token starts where the mask goes 0 -> 1 and ends where it goes
+        // 1 -> 0; carry the last bit of each word into the next
+        size_t start = 0;
+        uint64_t carry = 0;
+        for (size_t w = 0; w * 64 < n; ++w) {
+            uint64_t m = masks[w];
+            if ((w + 1) * 64 > n) m &= (1ULL << (n % 64)) - 1;
+            uint64_t edges = m ^ ((m << 1) | carry);
+            while (edges) {
+                size_t pos = w * 64 + __builtin_ctzll(edges);
+                if (m & (1ULL << (pos % 64))) {
+                    start = pos;
+                } else {
+                    fn(string_view(lower.data() + start, pos - start));
+                }
+                edges &= edges - 1;
+            }
+            carry = m >> 63;
+        }
+        if (carry) fn(string_view(lower.data() + start, n - start));
+        text.remove_prefix(n);
+    }
+}
+
+#endif // SIMD_TEXT_H
@@ -0,0 +1,303 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ChainingHash.h"
+#include "ProbingHash.h"
+#include "HashFunctions.h"
+#include "FinalAssignment.h"
+#include "MappedFile.h"
+#include "StringPool.h"
+#include "InvertedIndex.h"
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <utility>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace std;
+
+// Binary snapshot of what main() builds from an input file, so a later run
+// can skip reading, tokenizing and counting it. A SnapshotHeader is
+// followed by flat arrays, each starting on an 8 byte boundary:
+//   word_offsets  u32[words + 1]       word i is pool[off[i], off[i + 1])
+//   counts        i32[words]           indexed by StringPool id
+//   tokens        u32[tokens]          the token stream as word ids
+//   chain_entries SnapshotEntry[chain_entries]
+//   probe_entries SnapshotEntry[probe_entries]
+//   post_offsets  u32[words + 1]       word i's postings are postings[off[i], off[i + 1])
+//   postings      u8[postings_bytes]   InvertedIndex's encoded lists, as built
+//   pool          char[pool_bytes]
+// The inverted index is read straight out of the mapping, and the token
+// stream is only copied out when a query asks for it, so neither costs
+// anything per token at load time. What main() still does on load is per
+// word: it interns the words (in id order, which gives back the same ids)
+// and reinserts the table entries, which are keyed by word id in the order
+// the tables' for_each gave them.
+//
+// The header carries a version, the size and mtime of the input it was
+// built from and a checksum of everything after the header; a snapshot
+// that's off on any of them is rejected.
+const char SNAPSHOT_MAGIC[8] = { 'W', 'O', 'R', 'D', 'S', 'N', 'A', 'P' };
+const uint32_t SNAPSHOT_VERSION = 5;
+const uint32_t SNAPSHOT_MAX = 0xFFFFFFFFu;  // ids and offsets are 32-bit
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t source_size;
+    int64_t source_mtime;   // ns
+    uint64_t checksum;
+    uint64_t sentences;
+    int64_t sentence_ns;    // how long counting them took when built
+    uint64_t words;
+    uint64_t tokens;
+    uint64_t pool_bytes;
+    uint64_t chain_entries;
+    uint64_t probe_entries;
+    uint64_t postings_bytes;
+};
+
+struct SnapshotEntry {
+    uint32_t word;
+    int32_t value;
+};
+
+// identifies the input a snapshot was built from
+struct SourceStamp {
+    uint64_t size;
+    int64_t mtime;
+};
+
+inline bool source_stamp(const string& path, SourceStamp& out) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    out.size = static_cast<uint64_t>(st.st_size);
+    out.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+}
+
+// byte offsets of the arrays, from the counts in a header
+struct SnapshotLayout {
+    size_t word_offsets, counts, tokens, chain_entries, probe_entries, post_offsets, postings, pool, total;
+
+    explicit SnapshotLayout(const SnapshotHeader& h) {
+        size_t at = sizeof(SnapshotHeader);
+        word_offsets = take(at, (h.words + 1) * sizeof(uint32_t));
+        counts = take(at, h.words * sizeof(int32_t));
+        tokens = take(at, h.tokens * sizeof(uint32_t));
+        chain_entries = take(at, h.chain_entries * sizeof(SnapshotEntry));
+        probe_entries = take(at, h.probe_entries * sizeof(SnapshotEntry));
+        post_offsets = take(at, (h.words + 1) * sizeof(uint32_t));
+        postings = take(at, h.postings_bytes);
+        pool = take(at, h.pool_bytes);
+        total = at;
+    }
+
+private:
+    static size_t take(size_t& at, size_t bytes) {
+        size_t start = at;
+        at = (at + bytes + 7) / 8 * 8;
+        return start;
+    }
+};
+
+inline uint64_t snapshot_checksum(string_view payload) {
+    return WyHash()(payload);
+}
+
+// Writes the snapshot to path + ".tmp" and renames it over path, so a
+// reader never sees half a file. freq[i] must be word i of the pool and
+// index built from tokens, as main() builds them; the index's lists are
+// stored as they are and share the counts array with freq. Returns false if
+// the file can't be written or the arrays are too big for 32-bit offsets.
+inline bool write_snapshot(const string& path, const SourceStamp& source, const StringPool& words,
+                           const ResizableArray<pair<uint32_t,int>>& freq,
+                           const ResizableArray<uint32_t>& tokens, const InvertedIndex& index,
+                           size_t sentences, long long sentence_ns,
+                           const ChainingHash<uint32_t,int,IdHash>& chain,
+                           const ProbingHash<uint32_t,int,IdHash>& probe) {
+    if (freq.size() != words.size() || index.unique_words() != words.size() ||
+        index.token_count() != tokens.size() || tokens.size() >= SNAPSHOT_MAX) return false;
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof h.magic);
+    h.version = SNAPSHOT_VERSION;
+    h.source_size = source.size;
+    h.source_mtime = source.mtime;
+    h.sentences = sentences;
+    h.sentence_ns = sentence_ns;
+    h.words = freq.size();
+    h.tokens = tokens.size();
+    for (uint32_t id = 0; id < words.size(); ++id) h.pool_bytes += words.view(id).size();
+    if (h.pool_bytes >= SNAPSHOT_MAX) return false;
+    h.chain_entries = chain.size();
+    h.probe_entries = probe.size();
+    h.postings_bytes = index.postings_bytes();
+    if (h.postings_bytes >= SNAPSHOT_MAX) return false;
+
+    SnapshotLayout at(h);
+    string file(at.total, '\0');
+    auto array = [&](size_t offset) { return &file[offset]; };
+    uint32_t* word_offsets = reinterpret_cast<uint32_t*>(array(at.word_offsets));
+    int32_t* counts = reinterpret_cast<int32_t*>(array(at.counts));
+    uint32_t* token_ids = reinterpret_cast<uint32_t*>(array(at.tokens));
+    SnapshotEntry* chain_entries = reinterpret_cast<SnapshotEntry*>(array(at.chain_entries));
+    SnapshotEntry* probe_entries = reinterpret_cast<SnapshotEntry*>(array(at.probe_entries));
+    uint32_t* post_offsets = reinterpret_cast<uint32_t*>(array(at.post_offsets));
+    uint8_t* postings = reinterpret_cast<uint8_t*>(array(at.postings));
+    char* pool = array(at.pool);
+
+    uint32_t pool_at = 0;
+    for (uint32_t id = 0; id < words.size(); ++id) {
+        string_view w = words.view(id);
+        word_offsets[id] = pool_at;
+        if (!w.empty()) memcpy(pool + pool_at, w.data(), w.size());
+        pool_at += static_cast<uint32_t>(w.size());
+        if (freq[id].first != id || index.frequency(id) != static_cast<size_t>(freq[id].second)) return false;
+        counts[id] = freq[id].second;
+    }
+    word_offsets[words.size()] = pool_at;
+    uint32_t post_at = 0;
+    for (uint32_t id = 0; id < words.size(); ++id) {
+        InvertedIndex::Encoded list = index.encoded(id);
+        post_offsets[id] = post_at;
+        if (list.size) memcpy(postings + post_at, list.data, list.size);
+        post_at += static_cast<uint32_t>(list.size);
+    }
+    post_offsets[words.size()] = post_at;
+    for (size_t i = 0; i < tokens.size(); ++i) token_ids[i] = tokens[i];
+
+    SnapshotEntry* e = chain_entries;
+    chain.for_each([&](uint32_t id, int value) { *e++ = SnapshotEntry{id, value}; });
+    e = probe_entries;
+    probe.for_each([&](uint32_t id, int value) { *e++ = SnapshotEntry{id, value}; });
+
+    h.checksum = snapshot_checksum(string_view(file).substr(sizeof h));
+    memcpy(&file[0], &h, sizeof h);
+
+    string tmp = path + ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        if (!out.write(file.data(), file.size())) return false;
+    }
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+// A snapshot mapped read-only. Opening checks the header and checksum,
+// and that every word id and postings list outside the token stream is
+// well formed; token ids are checked as they're copied out. Otherwise the
+// accessors read the mapping directly.
+class Snapshot {
+public:
+    Snapshot(const string& path, const SourceStamp& source) : file(path), valid(false) {
+        valid = file.is_open() && check(source);
+    }
+
+    bool ok() const { return valid; }
+
+    size_t sentences() const { return h->sentences; }
+    long long sentence_ns() const { return h->sentence_ns; }
+    size_t unique_words() const { return h->words; }
+    size_t token_count() const { return h->tokens; }
+
+    string_view word(uint32_t id) const {
+        return string_view(pool + word_offsets[id], word_offsets[id + 1] - word_offsets[id]);
+    }
+    int count(uint32_t id) const { return counts[id]; }
+
+    // appends the token stream to out; false, with nothing appended, if an
+    // id is out of range
+    bool copy_tokens(ResizableArray<uint32_t>& out) const {
+        // a list has to end on a final varint byte, or decoding it would
+        // run on into the next one
+        for (size_t i = 0; i < h->words; ++i) {
+            if (post_offsets[i] > post_offsets[i + 1] || counts[i] < 0) return false;
+            if (post_offsets[i] < post_offsets[i + 1] && (postings[post_offsets[i + 1] - 1] & 0x80)) return false;
+        }
+        if (post_offsets[h->words] != h->postings_bytes) return false;
+        out.reserve(out.size() + h->tokens);
+        for (size_t i = 0; i < h->tokens; ++i) out.push_back(token_ids[i]);
+        return true;
+    }
+
+    // the stored inverted index, in place; good for as long as this is
+    InvertedIndex index() const {
+        return InvertedIndex::over(postings, post_offsets, counts, h->words, h->tokens);
+    }
+
+    // fn(word id, value) for every entry of the stored tables
+    template<typename Fn>
+    void for_each_chain_entry(Fn fn) const {
+        for (size_t e = 0; e < h->chain_entries; ++e) fn(chain_entries[e].word, chain_entries[e].value);
+    }
+
+    template<typename Fn>
+    void for_each_probe_entry(Fn fn) const {
+        for (size_t e = 0; e < h->probe_entries; ++e) fn(probe_entries[e].word, probe_entries[e].value);
+    }
+
+private:
+    MappedFile file;
+    bool valid;
+    const SnapshotHeader* h = nullptr;
+    const uint32_t* word_offsets = nullptr;
+    const int32_t* counts = nullptr;
+    const uint32_t* token_ids = nullptr;
+    const SnapshotEntry* chain_entries = nullptr;
+    const SnapshotEntry* probe_entries = nullptr;
+    const uint32_t* post_offsets = nullptr;
+    const uint8_t* postings = nullptr;
+    const char* pool = nullptr;
+
+    bool check(const SourceStamp& source) {
+        string_view bytes = file.view();
+        if (bytes.size() < sizeof(SnapshotHeader)) return false;
+        h = reinterpret_cast<const SnapshotHeader*>(bytes.data());
+        if (memcmp(h->magic, SNAPSHOT_MAGIC, sizeof h->magic) != 0 || h->version != SNAPSHOT_VERSION) return false;
+        if (h->source_size != source.size || h->source_mtime != source.mtime) return false;
+        // counts bigger than the file can't be real, and keep the layout
+        // arithmetic from overflowing
+        for (uint64_t n : { h->words, h->tokens, h->pool_bytes, h->chain_entries, h->probe_entries, h->postings_bytes }) {
+            if (n > bytes.size()) return false;
+        }
+        SnapshotLayout at(*h);
+        if (at.total != bytes.size()) return false;
+        if (snapshot_checksum(bytes.substr(sizeof(SnapshotHeader))) != h->checksum) return false;
+
+        const char* base = bytes.data();
+        word_offsets = reinterpret_cast<const uint32_t*>(base + at.word_offsets);
+        counts = reinterpret_cast<const int32_t*>(base + at.counts);
+        token_ids = reinterpret_cast<const uint32_t*>(base + at.tokens);
+        chain_entries = reinterpret_cast<const SnapshotEntry*>(base + at.chain_entries);
+        probe_entries = reinterpret_cast<const SnapshotEntry*>(base + at.probe_entries);
+        post_offsets = reinterpret_cast<const uint32_t*>(base + at.post_offsets);
+        postings = reinterpret_cast<const uint8_t*>(base + at.postings);
+        pool = base + at.pool;
+
+        for (size_t i = 0; i < h->words; ++i) {
+            if (word_offsets[i] > word_offsets[i + 1]) return false;
+        }
+        if (word_offsets[h->words] != h->pool_bytes) return false;
+        // a list has to end on a final varint byte, or decoding it would
+        // run on into the next one
+        for (size_t i = 0; i < h->words; ++i) {
+            if (post_offsets[i] > post_offsets[i + 1] || counts[i] < 0) return false;
+            if (post_offsets[i] < post_offsets[i + 1] && (postings[post_offsets[i + 1] - 1] & 0x80)) return false;
+        }
+        if (post_offsets[h->words] != h->postings_bytes) return false;
+        for (size_t e = 0; e < h->chain_entries; ++e) {
+            if (chain_entries[e].word >= h->words) return false;
+        }
+        for (size_t e = 0; e < h->probe_entries; ++e) {
+            if (probe_entries[e].word >= h->words) return false;
+        }
+        return true;
+    }
+};
+
+#endif // SNAPSHOT_H
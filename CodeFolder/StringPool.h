@@ -0,0 +1,120 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include "HashFunctions.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+using namespace std;
+
+// Interns words: every distinct word is stored once, in 64 KB character
+// blocks that never move, and gets a 32-bit id. Ids are handed out 0, 1,
+// 2, ... in the order words are first interned, so for a text they are
+// also first-occurrence order. A token stream or a table keyed by id costs
+// 4 bytes per key, and the word's hash is taken once when it's interned;
+// growing the index reuses the stored hashes instead of rehashing strings.
+class StringPool {
+public:
+    StringPool() : slots(1024, NONE), block_at(nullptr), block_left(0), chars(0) {}
+
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    // the id of s, adding s if it's new
+    uint32_t intern(string_view s) {
+        uint64_t h = WyHash()(s);
+        size_t idx = find_slot(s, h);
+        if (slots[idx] != NONE) return slots[idx];
+
+        if ((entries.size() + 1) * 4 > slots.size() * 3) {
+            grow();
+            idx = find_slot(s, h);
+        }
+        uint32_t id = static_cast<uint32_t>(entries.size());
+        entries.push_back(Entry{store(s), static_cast<uint32_t>(s.size()), h});
+        slots[idx] = id;
+        return id;
+    }
+
+    // false if s was never interned
+    bool lookup(string_view s, uint32_t& id_out) const {
+        uint32_t id = slots[find_slot(s, WyHash()(s))];
+        if (id == NONE) return false;
+        id_out = id;
+        return true;
+    }
+
+    // good for as long as the pool is
+    string_view view(uint32_t id) const { return string_view(entries[id].data, entries[id].len); }
+    uint64_t hash(uint32_t id) const { return entries[id].hash; }
+    size_t size() const { return entries.size(); }
+
+    // characters stored plus the per-word and index overhead
+    size_t bytes() const {
+        return chars + entries.size() * sizeof(Entry) + slots.size() * sizeof(uint32_t);
+    }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+    static constexpr size_t BLOCK = 64 * 1024;
+
+    struct Entry {
+        const char* data;
+        uint32_t len;
+        uint64_t hash;
+    };
+
+    vector<Entry> entries;
+    vector<uint32_t> slots;     // open addressing over ids, power-of-two size
+    vector<unique_ptr<char[]>> blocks;
+    char* block_at;
+    size_t block_left;
+    size_t chars;
+
+    // slot holding s, or the empty slot where it would go
+    size_t find_slot(string_view s, uint64_t h) const {
+        size_t mask = slots.size() - 1;
+        size_t idx = bucket_index(h, slots.size());
+        while (slots[idx] != NONE) {
+            const Entry& e = entries[slots[idx]];
+            if (e.hash == h && string_view(e.data, e.len) == s) break;
+            idx = (idx + 1) & mask;
+        }
+        return idx;
+    }
+
+    void grow() {
+        vector<uint32_t> bigger(slots.size() * 2, NONE);
+        size_t mask = bigger.size() - 1;
+        for (uint32_t id = 0; id < entries.size(); ++id) {
+            size_t idx = bucket_index(entries[id].hash, bigger.size());
+            while (bigger[idx] != NONE) idx = (idx + 1) & mask;
+            bigger[idx] = id;
+        }
+        slots.swap(bigger);
+    }
+
+    // words longer than a block get a block of their own
+    const char* store(string_view s) {
+        if (s.size() > block_left) {
+            size_t n = max(BLOCK, s.size());
+            blocks.push_back(unique_ptr<char[]>(new char[n]));
+            block_at = blocks.back().get();
+            block_left = n;
+        }
+        char* p = block_at;
+        if (!s.empty()) memcpy(p, s.data(), s.size());
+        block_at += s.size();
+        block_left -= s.size();
+        chars += s.size();
+        return p;
+    }
+};
+
+#endif // STRING_POOL_H
@@ -0,0 +1,111 @@
+#ifndef STRIPED_HASH_H
+#define STRIPED_HASH_H
+
+#include "HashTable.h"
+#include "HashFunctions.h"
+#include <list>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>  // for size_t
+
+using namespace std;
+
+// Separate chaining that many threads can update at once. Buckets are
+// split over a fixed set of stripes (bucket i belongs to stripe
+// i % stripes) and each stripe has its own mutex, so two threads only wait
+// on each other when their keys land in the same stripe. Chains are
+// std::list so a value never moves once it's in the table.
+//
+// increment() and insert() are the thread-safe way to update a value.
+// find_or_insert() hands out a reference that outlives the lock, so it's
+// only safe while no other thread writes that key.
+template<typename Key, typename Value, typename Hasher = WyHash>
+class StripedHash : public HashTable<Key,Value> {
+public:
+    explicit StripedHash(size_t table_size, size_t stripes = 64, const Hasher& hf = Hasher())
+      : hsize(table_size), table(table_size), locks(stripes), count(0), hasher(hf) {}
+    ~StripedHash() override = default;
+
+    void insert(const Key& key, const Value& value) override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        lock_guard<mutex> guard(stripe_of(idx));
+        upsert(idx, key, value) = value;
+    }
+
+    Value& find_or_insert(const Key& key, const Value& initial) override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        lock_guard<mutex> guard(stripe_of(idx));
+        return upsert(idx, key, initial);
+    }
+
+    void increment(const Key& key, const Value& delta = Value(1)) override {
+        increment<Key>(key, delta);
+    }
+
+    // Heterogeneous version, e.g. a string_view token: the hash is taken
+    // outside the lock and a Key is only built when K is new.
+    template<typename K>
+    void increment(const K& key, const Value& delta = Value(1)) {
+        size_t idx = bucket_index(hasher(key), hsize);
+        lock_guard<mutex> guard(stripe_of(idx));
+        upsert(idx, key, Value()) += delta;
+    }
+
+    bool find(const Key& key, Value& value_out) const override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        lock_guard<mutex> guard(stripe_of(idx));
+        for (auto& kv : table[idx]) {
+            if (kv.first == key) {
+                value_out = kv.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool erase(const Key& key) override {
+        size_t idx = bucket_index(hasher(key), hsize);
+        lock_guard<mutex> guard(stripe_of(idx));
+        auto& chain = table[idx];
+        for (auto it = chain.begin(); it != chain.end(); ++it) {
+            if (it->first == key) {
+                chain.erase(it);
+                count.fetch_sub(1, memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size() const override { return count.load(memory_order_relaxed); }
+
+    double load_factor() const override {
+        return static_cast<double>(size()) / hsize;
+    }
+
+private:
+    // a mutex to a cache line, so neighbouring stripes don't false-share
+    struct alignas(64) Stripe { mutable mutex m; };
+
+    size_t hsize;
+    vector<list<pair<Key,Value>>> table;
+    vector<Stripe> locks;
+    atomic<size_t> count;
+    Hasher hasher;
+
+    mutex& stripe_of(size_t idx) const { return locks[idx % locks.size()].m; }
+
+    // caller holds the bucket's stripe
+    template<typename K>
+    Value& upsert(size_t idx, const K& key, const Value& initial) {
+        for (auto& kv : table[idx]) {
+            if (kv.first == key) return kv.second;
+        }
+        table[idx].push_back(make_pair(Key(key), initial));
+        count.fetch_add(1, memory_order_relaxed);
+        return table[idx].back().second;
+    }
+};
+
+#endif // STRIPED_HASH_H
@@ -0,0 +1,178 @@
+#ifndef SUBSTRING_SEARCH_H
+#define SUBSTRING_SEARCH_H
+
+#include "FinalAssignment.h"
+#include "SimdText.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// Multi-pattern substring search over raw text, ASCII case-insensitive.
+// Both searchers report every (pattern, byte offset) in offset order, then
+// pattern order for matches at the same offset.
+struct SubstringMatch {
+    size_t pattern;
+    size_t offset;
+};
+
+inline unsigned char fold_case(char c) {
+    return static_cast<unsigned char>(is_ascii_letter(c) ? (c | 0x20) : c);
+}
+
+inline bool equal_folded(const char* a, string_view b) {
+    for (size_t i = 0; i < b.size(); ++i) {
+        if (fold_case(a[i]) != fold_case(b[i])) return false;
+    }
+    return true;
+}
+
+// Rabin-Karp: one polynomial hash per distinct pattern length rolls over
+// the text in a single pass, all mod 2^64. Adding a byte is h * B + c,
+// dropping the byte that left the window is - c * B^len. Patterns of the
+// same length share a window, so each byte costs one update per length
+// plus a compare against that length's (at most 8) pattern hashes.
+inline ResizableArray<SubstringMatch> rabin_karp_search(string_view text, const ResizableArray<string>& patterns) {
+    const uint64_t B = 0x100000001B3ULL;
+    struct Group {
+        size_t len;
+        uint64_t drop;   // B^(len - 1), weight of the byte leaving the window
+        uint64_t hash;
+        vector<pair<uint64_t,size_t>> wanted;   // (pattern hash, pattern)
+    };
+    vector<Group> groups;
+    for (size_t p = 0; p < patterns.size(); ++p) {
+        const string& pat = patterns[p];
+        if (pat.empty() || pat.size() > text.size()) continue;
+        uint64_t h = 0;
+        for (char c : pat) h = h * B + fold_case(c);
+        auto g = find_if(groups.begin(), groups.end(), [&](const Group& x) { return x.len == pat.size(); });
+        if (g == groups.end()) {
+            uint64_t drop = 1;
+            for (size_t i = 1; i < pat.size(); ++i) drop *= B;
+            groups.push_back(Group{pat.size(), drop, 0, {}});
+            g = groups.end() - 1;
+        }
+        g->wanted.push_back(make_pair(h, p));
+    }
+
+    vector<SubstringMatch> found;
+    for (size_t i = 0; i < text.size(); ++i) {
+        uint64_t in = fold_case(text[i]);
+        for (Group& g : groups) {
+            if (i >= g.len) g.hash -= fold_case(text[i - g.len]) * g.drop;
+            g.hash = g.hash * B + in;
+            if (i + 1 < g.len) continue;
+            size_t start = i + 1 - g.len;
+            for (const auto& w : g.wanted) {
+                if (w.first == g.hash && equal_folded(text.data() + start, patterns[w.second])) {
+                    found.push_back(SubstringMatch{w.second, start});
+                }
+            }
+        }
+    }
+    // found is in end-offset order; shorter patterns end first
+    sort(found.begin(), found.end(), [](const SubstringMatch& a, const SubstringMatch& b) {
+        return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+    });
+    ResizableArray<SubstringMatch> out;
+    for (const SubstringMatch& m : found) out.push_back(m);
+    return out;
+}
+
+// Aho-Corasick over the same folded bytes: a trie of the patterns with
+// every missing edge filled in from the failure links, so the scan is one
+// table lookup per byte however many patterns there are. Only the
+// patterns' lengths are kept, so they needn't outlive the automaton.
+class AhoCorasick {
+public:
+    explicit AhoCorasick(const ResizableArray<string>& patterns) {
+        nodes.push_back(Node());
+        for (size_t p = 0; p < patterns.size(); ++p) {
+            lengths.push_back(patterns[p].size());
+            if (patterns[p].empty()) continue;
+            int32_t at = 0;
+            for (char c : patterns[p]) {
+                unsigned char b = fold_case(c);
+                if (nodes[at].next[b] == 0) {
+                    nodes[at].next[b] = static_cast<int32_t>(nodes.size());
+                    nodes.push_back(Node());
+                }
+                at = nodes[at].next[b];
+            }
+            nodes[at].ends.push_back(p);
+        }
+        link_failures();
+    }
+
+    ResizableArray<SubstringMatch> search(string_view text) const {
+        vector<SubstringMatch> found;
+        int32_t at = 0;
+        for (size_t i = 0; i < text.size(); ++i) {
+            at = nodes[at].next[fold_case(text[i])];
+            for (int32_t n = at; n > 0; n = nodes[n].out) {
+                for (size_t p : nodes[n].ends) found.push_back(SubstringMatch{p, i + 1 - lengths[p]});
+            }
+        }
+        sort(found.begin(), found.end(), [](const SubstringMatch& a, const SubstringMatch& b) {
+            return a.offset != b.offset ? a.offset < b.offset : a.pattern < b.pattern;
+        });
+        ResizableArray<SubstringMatch> out;
+        for (const SubstringMatch& m : found) out.push_back(m);
+        return out;
+    }
+
+private:
+    struct Node {
+        int32_t next[256] = {};
+        int32_t fail = 0;
+        int32_t out = 0;        // nearest node down the failure chain that ends a pattern
+        vector<size_t> ends;    // patterns that end here
+    };
+    vector<size_t> lengths;     // of pattern p, to turn an end into an offset
+    vector<Node> nodes;
+
+    // breadth first, so a node's failure target is finished before it
+    void link_failures() {
+        vector<int32_t> queue;
+        for (int b = 0; b < 256; ++b) {
+            if (nodes[0].next[b]) queue.push_back(nodes[0].next[b]);
+        }
+        for (size_t q = 0; q < queue.size(); ++q) {
+            int32_t n = queue[q];
+            const Node& fail = nodes[nodes[n].fail];
+            nodes[n].out = fail.ends.empty() ? fail.out : nodes[n].fail;
+            for (int b = 0; b < 256; ++b) {
+                int32_t child = nodes[n].next[b];
+                if (child) {
+                    nodes[child].fail = nodes[nodes[n].fail].next[b];
+                    queue.push_back(child);
+                } else {
+                    nodes[n].next[b] = nodes[nodes[n].fail].next[b];
+                }
+            }
+        }
+    }
+};
+
+// 1-based number of the token each offset falls in, numbered like the
+// search index; an offset between tokens gets the next token's number.
+// offsets must be ascending.
+inline ResizableArray<size_t> token_numbers(string_view text, const ResizableArray<SubstringMatch>& matches) {
+    ResizableArray<size_t> numbers;
+    size_t token = 0, i = 0;
+    for (size_t m = 0; m < matches.size(); ++m) {
+        for (; i <= matches[m].offset && i < text.size(); ++i) {
+            if (is_ascii_alnum(text[i]) && (i == 0 || !is_ascii_alnum(text[i - 1]))) token++;
+        }
+        bool inside = matches[m].offset < text.size() && is_ascii_alnum(text[matches[m].offset]);
+        numbers.push_back(inside ? token : token + 1);
+    }
+    return numbers;
+}
+
+#endif // SUBSTRING_SEARCH_H
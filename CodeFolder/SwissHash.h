@@ -0,0 +1,193 @@
+#ifndef SWISS_HASH_H
+#define SWISS_HASH_H
+
+#include "HashTable.h"
+#include "HashFunctions.h"
+#include <vector>
+#include <cstdint>
+#include <cstdlib>  // for size_t
+#include <cassert>
+#include <utility>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Open addressing with SwissTable-style control bytes. Every slot has one
+// metadata byte in its own array: EMPTY, DELETED, or the low 7 bits of the
+// key's hash. A probe loads a group of 16 control bytes and compares all of
+// them against the hash fragment at once (SSE2 when available), so key
+// strings are only compared for slots whose fragment already matched and a
+// miss usually ends at the first group that still has an EMPTY byte.
+template<typename Key, typename Value, typename Hasher = WyHash>
+class SwissHash : public HashTable<Key,Value> {
+public:
+    explicit SwissHash(size_t table_size, double max_load = 0.875, const Hasher& hf = Hasher())
+      : cap(0), count(0), deleted(0), max_load(max_load), hasher(hf) {
+        assert(max_load > 0 && max_load < 1 && "SwissHash needs a free slot per probe");
+        allocate(round_up(table_size));
+    }
+    ~SwissHash() override = default;
+
+    void insert(const Key& key, const Value& value) override {
+        find_or_insert(key, value) = value;
+    }
+
+    Value& find_or_insert(const Key& key, const Value& initial) override {
+        uint64_t h = hash_of(key);
+        size_t idx;
+        if (locate(h, key, idx)) return slots[idx].second;
+        // tombstones use up probe room like keys do; when they're what
+        // filled the table, rebuilding at the same size is enough
+        if (count + deleted + 1 > max_load * cap) rehash(count + 1 > max_load * cap / 2 ? cap * 2 : cap);
+        return slots[place(h, key, initial)].second;
+    }
+
+    // A slot whose group still has an EMPTY byte can go straight back to
+    // EMPTY: no probe has ever gone past that group. Anywhere else it
+    // becomes DELETED so later keys in the probe sequence stay reachable.
+    bool erase(const Key& key) override {
+        size_t idx;
+        if (!locate(hash_of(key), key, idx)) return false;
+        size_t g = idx / GROUP;
+        bool empty_in_group = match(&ctrl[g * GROUP], CTRL_EMPTY) != 0;
+        ctrl[idx] = empty_in_group ? CTRL_EMPTY : CTRL_DELETED;
+        if (!empty_in_group) deleted++;
+        slots[idx] = pair<Key,Value>();
+        count--;
+        return true;
+    }
+
+    bool find(const Key& key, Value& value_out) const override {
+        size_t idx;
+        if (!locate(hash_of(key), key, idx)) return false;
+        value_out = slots[idx].second;
+        return true;
+    }
+
+    size_t size() const override { return count; }
+    double load_factor() const override { return static_cast<double>(count) / cap; }
+    size_t capacity() const { return cap; }
+
+private:
+    static constexpr int8_t CTRL_EMPTY = -128;
+    static constexpr int8_t CTRL_DELETED = -2;
+    static constexpr size_t GROUP = 16;
+
+    size_t cap;
+    size_t count;
+    size_t deleted;
+    double max_load;
+    Hasher hasher;
+    vector<int8_t> ctrl;
+    vector<pair<Key,Value>> slots;
+
+    // the top 7 bits of the mixed hash are the fragment, the bits below
+    // them pick the first group
+    uint64_t hash_of(const Key& key) const { return hash_mix(hasher(key)); }
+    static int8_t fragment(uint64_t h) { return static_cast<int8_t>(h >> 57); }
+    size_t first_group(uint64_t h) const { return fast_range(h << 7, cap / GROUP); }
+
+    // bit i set when control byte i of the group equals b
+    static uint32_t match(const int8_t* group, int8_t b) {
+#ifdef __SSE2__
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl_bytes, _mm_set1_epi8(b))));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; ++i) {
+            if (group[i] == b) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    // EMPTY and DELETED are the only control bytes with the sign bit set
+    static uint32_t match_free(const int8_t* group) {
+#ifdef __SSE2__
+        __m128i ctrl_bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_bytes));
+#else
+        uint32_t mask = 0;
+        for (size_t i = 0; i < GROUP; ++i) {
+            if (group[i] < 0) mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
+
+    static int lowest_bit(uint32_t mask) { return __builtin_ctz(mask); }
+
+    // triangular probing over whole groups visits every group once
+    bool locate(uint64_t h, const Key& key, size_t& idx_out) const {
+        size_t groups = cap / GROUP;
+        size_t g = first_group(h);
+        int8_t frag = fragment(h);
+        for (size_t step = 1; step <= groups; ++step) {
+            const int8_t* group = &ctrl[g * GROUP];
+            for (uint32_t m = match(group, frag); m; m &= m - 1) {
+                size_t idx = g * GROUP + lowest_bit(m);
+                if (slots[idx].first == key) {
+                    idx_out = idx;
+                    return true;
+                }
+            }
+            if (match(group, CTRL_EMPTY)) return false;
+            g = (g + step) & (groups - 1);
+        }
+        return false;
+    }
+
+    // key is known to be absent and there is room for it
+    size_t place(uint64_t h, Key key, Value value) {
+        size_t groups = cap / GROUP;
+        size_t g = first_group(h);
+        for (size_t step = 1;; ++step) {
+            uint32_t m = match_free(&ctrl[g * GROUP]);
+            if (m) {
+                size_t idx = g * GROUP + lowest_bit(m);
+                if (ctrl[idx] == CTRL_DELETED) deleted--;
+                ctrl[idx] = fragment(h);
+                slots[idx].first = move(key);
+                slots[idx].second = move(value);
+                count++;
+                return idx;
+            }
+            g = (g + step) & (groups - 1);
+        }
+    }
+
+    void allocate(size_t new_cap) {
+        cap = new_cap;
+        count = 0;
+        deleted = 0;
+        ctrl.assign(cap, CTRL_EMPTY);
+        slots.clear();
+        slots.resize(cap);
+    }
+
+    void rehash(size_t new_cap) {
+        vector<int8_t> old_ctrl;
+        vector<pair<Key,Value>> old_slots;
+        old_ctrl.swap(ctrl);
+        old_slots.swap(slots);
+        allocate(new_cap);
+        for (size_t i = 0; i < old_ctrl.size(); ++i) {
+            if (old_ctrl[i] >= 0) {
+                // hash before the key is moved into place's argument
+                uint64_t h = hash_of(old_slots[i].first);
+                place(h, move(old_slots[i].first), move(old_slots[i].second));
+            }
+        }
+    }
+
+    // power of two, at least one group
+    static size_t round_up(size_t n) {
+        size_t c = GROUP;
+        while (c < n) c *= 2;
+        return c;
+    }
+};
+
+#endif // SWISS_HASH_H
@@ -0,0 +1,210 @@
+#include "ChainingHash.h"
+#include "ProbingHash.h"
+#include "SwissHash.h"
+#include "PoolChainingHash.h"
+#include "FlatHash.h"
+#include "HashFunctions.h"
+#include "FinalAssignment.h"
+#include "TextUtils.h"
+#include "MappedFile.h"
+#include "SimdText.h"
+#include "BenchHarness.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+using namespace std;
+
+// Word counting sweeps over table type, hash function, table size, load
+// factor and input size. Every configuration counts the same token stream
+// into a fresh table per iteration; building the table is outside the
+// timing, and tokens are counted by reference, never copied.
+//
+//   ./TableBench <input_file> [--warmup N] [--iterations N]
+//                [--format text|csv|json] [--out FILE] [--stats FILE]
+//
+// --stats writes chaining and probing table statistics for every hasher at
+// the default size; lookup probe counts need a make STATS=1 build. The
+// dispatch sweep puts the virtual HashTable interface next to the same
+// tables called directly.
+
+const size_t DEFAULT_SIZE = 20011;
+const double DEFAULT_LOAD = 0.7;
+
+// names for ProbingHash's probe schemes, in ProbeScheme order
+const char* PROBE_TABLES[] = { "probing", "quadratic", "double", "hopscotch", "cuckoo" };
+
+// the scheme a table name stands for, if it's a ProbingHash one
+bool probe_scheme_for(const string& table, ProbeScheme& scheme) {
+    for (int s = 0; s < 5; ++s) {
+        if (table == PROBE_TABLES[s]) {
+            scheme = static_cast<ProbeScheme>(s);
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Hasher>
+BenchResult count_row(const string& sweep, const string& table, const char* hasher, size_t size, double load,
+                      const ResizableArray<string>& tokens, const BenchConfig& cfg) {
+    BenchStats stats;
+    ProbeScheme scheme;
+    bool probing = probe_scheme_for(table, scheme);
+    if (table == "chaining") {
+        stats = measure(cfg, [&] { ChainingHash<string,int,Hasher> t(size); return time_count(t, tokens); });
+    } else if (table == "pool") {
+        stats = measure(cfg, [&] { PoolChainingHash<string,int,Hasher> t(size); return time_count(t, tokens); });
+    } else if (probing) {
+        stats = measure(cfg, [&] { ProbingHash<string,int,Hasher> t(size, load, GROW_REHASH, scheme); return time_count(t, tokens); });
+    } else if (table == "flat") {
+        stats = measure(cfg, [&] { FlatHash<string,int,Hasher> t(size); return time_count(t, tokens); });
+    } else {
+        stats = measure(cfg, [&] { SwissHash<string,int,Hasher> t(size, load); return time_count(t, tokens); });
+    }
+    bool open_addressing = probing || table == "swiss";  // flat's load is fixed at 0.7
+    return BenchResult{sweep, table, hasher, size, open_addressing ? load : 0.0, tokens.size(), stats};
+}
+
+// count the tokens, look each up again plus a miss per token, then dump
+// the table's stats
+template<typename Hasher>
+void stats_rows(ostream& out, const char* hasher, const ResizableArray<string>& tokens) {
+    ChainingHash<string,int,Hasher> chain(DEFAULT_SIZE);
+    ProbingHash<string,int,Hasher> probe(DEFAULT_SIZE, DEFAULT_LOAD);
+    int v;
+    for (const string& w : tokens) {
+        chain.increment(w);
+        probe.increment(w);
+    }
+    for (const string& w : tokens) {
+        chain.find(w, v);
+        probe.find(w, v);
+        chain.find("@" + w, v);
+        probe.find("@" + w, v);
+    }
+    write_table_stats(out, string("chaining / ") + hasher, chain.stats());
+    write_table_stats(out, string("probing / ") + hasher, probe.stats());
+}
+
+// time_count with the table only known as a HashTable&; noinline so the
+// compiler can't see what it really is and turn the calls back into
+// direct ones
+__attribute__((noinline)) long long time_count_virtual(HashTable<string,int>& table, const ResizableArray<string>& tokens) {
+    return time_count(table, tokens);
+}
+
+// The same counting loop through the virtual interface and on the concrete
+// type, for the existing probing table and for FlatHash (growing, and
+// with a compile-time capacity big enough for the vocabulary).
+void dispatch_rows(vector<BenchResult>& out, const ResizableArray<string>& tokens, const BenchConfig& cfg) {
+    const size_t FIXED = 32768;
+    typedef FlatHash<string,int> Flat;
+    typedef FlatHash<string,int,WyHash,equal_to<>,LinearProbe,FixedCapacity<FIXED>> FixedFlat;
+    auto row = [&](const char* table, size_t size, double load, BenchStats stats) {
+        out.push_back(BenchResult{"dispatch", table, "wyhash", size, load, tokens.size(), stats});
+    };
+    row("probing-virtual", DEFAULT_SIZE, DEFAULT_LOAD, measure(cfg, [&] {
+        ProbingHash<string,int> t(DEFAULT_SIZE, DEFAULT_LOAD);
+        return time_count_virtual(t, tokens);
+    }));
+    row("probing-direct", DEFAULT_SIZE, DEFAULT_LOAD, measure(cfg, [&] {
+        ProbingHash<string,int> t(DEFAULT_SIZE, DEFAULT_LOAD);
+        return time_count(t, tokens);
+    }));
+    row("flat-virtual", DEFAULT_SIZE, 0.7, measure(cfg, [&] {
+        HashTableAdapter<Flat> t(DEFAULT_SIZE);
+        return time_count_virtual(t, tokens);
+    }));
+    row("flat-direct", DEFAULT_SIZE, 0.7, measure(cfg, [&] {
+        Flat t(DEFAULT_SIZE);
+        return time_count(t, tokens);
+    }));
+    row("flat-fixed", FIXED, 0.7, measure(cfg, [&] {
+        FixedFlat t;
+        return time_count(t, tokens);
+    }));
+}
+
+// one row per hasher for a table configuration
+void hasher_rows(vector<BenchResult>& out, const string& sweep, const string& table, size_t size, double load,
+                 const ResizableArray<string>& tokens, const BenchConfig& cfg) {
+    out.push_back(count_row<HornerHash>(sweep, table, "horner", size, load, tokens, cfg));
+    out.push_back(count_row<SimpleModHash>(sweep, table, "sum", size, load, tokens, cfg));
+    out.push_back(count_row<FNV1aHash>(sweep, table, "fnv1a", size, load, tokens, cfg));
+    out.push_back(count_row<WyHash>(sweep, table, "wyhash", size, load, tokens, cfg));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc % 2 != 0) {
+        cerr << "Usage: " << argv[0] << " <input_file> [--warmup N] [--iterations N] [--format text|csv|json] [--out FILE] [--stats FILE]" << endl;
+        return 1;
+    }
+    BenchConfig cfg = {2, 10};
+    string format = "text", out_path, stats_path;
+    for (int a = 2; a + 1 < argc; a += 2) {
+        string flag = argv[a];
+        if (flag == "--warmup") cfg.warmup = atoi(argv[a + 1]);
+        else if (flag == "--iterations") cfg.iterations = max(1, atoi(argv[a + 1]));
+        else if (flag == "--format") format = argv[a + 1];
+        else if (flag == "--out") out_path = argv[a + 1];
+        else if (flag == "--stats") stats_path = argv[a + 1];
+        else {
+            cerr << "Unknown option " << flag << endl;
+            return 1;
+        }
+    }
+    MappedFile infile(argv[1]);
+    if (!infile.is_open()) {
+        cerr << "Error opening files";
+        return 1;
+    }
+    ResizableArray<string> tokens;
+    for_each_token_simd(gutenberg_body(infile.view()), [&](string_view w) { tokens.push_back(string(w)); });
+
+    const char* tables[] = { "chaining", "pool", "probing", "swiss", "flat" };
+    vector<BenchResult> results;
+
+    for (const char* t : tables) hasher_rows(results, "hasher", t, DEFAULT_SIZE, DEFAULT_LOAD, tokens, cfg);
+
+    for (size_t size : { 5003, 10007, 20011, 40009 }) {
+        for (const char* t : tables) results.push_back(count_row<WyHash>("table_size", t, "wyhash", size, DEFAULT_LOAD, tokens, cfg));
+    }
+
+    // open addressing only; chaining has no load limit. Swiss sizes itself
+    // to a power of two, so it gets a size that's exactly one.
+    for (double load : { 0.5, 0.6, 0.7, 0.8, 0.9 }) {
+        for (const char* t : PROBE_TABLES) results.push_back(count_row<WyHash>("load_factor", t, "wyhash", DEFAULT_SIZE, load, tokens, cfg));
+        results.push_back(count_row<WyHash>("load_factor", "swiss", "wyhash", 16384, load, tokens, cfg));
+    }
+
+    dispatch_rows(results, tokens, cfg);
+
+    // the text repeated: same vocabulary, more hits per key
+    for (size_t scale : { 1, 4, 16 }) {
+        ResizableArray<string> scaled;
+        scaled.reserve(tokens.size() * scale);
+        for (size_t k = 0; k < scale; ++k) {
+            for (const string& w : tokens) scaled.push_back(w);
+        }
+        for (const char* t : tables) results.push_back(count_row<WyHash>("input_size", t, "wyhash", DEFAULT_SIZE, DEFAULT_LOAD, scaled, cfg));
+    }
+
+    ofstream file;
+    if (!out_path.empty()) file.open(out_path);
+    ostream& out = out_path.empty() ? cout : file;
+    if (format == "csv") write_results_csv(out, results);
+    else if (format == "json") write_results_json(out, results);
+    else write_results_text(out, results);
+
+    if (!stats_path.empty()) {
+        ofstream stats(stats_path);
+        stats_rows<HornerHash>(stats, "horner", tokens);
+        stats_rows<SimpleModHash>(stats, "sum", tokens);
+        stats_rows<FNV1aHash>(stats, "fnv1a", tokens);
+        stats_rows<WyHash>(stats, "wyhash", tokens);
+    }
+    return 0;
+}
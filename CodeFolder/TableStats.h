@@ -0,0 +1,107 @@
+#ifndef TABLE_STATS_H
+#define TABLE_STATS_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+// What a table looks like inside, for tuning size and hash choice.
+//
+// Everything structural (histogram, tombstones, bytes) is worked out by
+// scanning the table when stats() is called, so it costs nothing until
+// then. Per-lookup probe counts and resize events have to be recorded as
+// they happen; that only happens when built with -DHASH_STATS (make
+// STATS=1). Without it LookupCounters is empty and every call on it is an
+// inline no-op the compiler throws away.
+
+#ifdef HASH_STATS
+struct LookupCounters {
+    static constexpr bool enabled = true;
+    size_t hits = 0, hit_probes = 0, max_hit_probes = 0;
+    size_t misses = 0, miss_probes = 0, max_miss_probes = 0;
+    size_t resizes = 0;
+
+    void hit(size_t probes) {
+        hits++;
+        hit_probes += probes;
+        max_hit_probes = max(max_hit_probes, probes);
+    }
+    void miss(size_t probes) {
+        misses++;
+        miss_probes += probes;
+        max_miss_probes = max(max_miss_probes, probes);
+    }
+    void resized() { resizes++; }
+};
+#else
+struct LookupCounters {
+    static constexpr bool enabled = false;
+    void hit(size_t) {}
+    void miss(size_t) {}
+    void resized() {}
+};
+#endif
+
+struct TableStats {
+    string layout;
+    size_t size;
+    size_t slots;               // buckets or slots
+    // chaining: number of buckets with a chain of length i;
+    // probing: number of keys that take i + 1 probes to reach
+    vector<size_t> histogram;
+    size_t tombstones;
+    size_t bytes;               // table storage, not heap owned by the keys
+
+    // only filled in with HASH_STATS; a lookup is a find() or the search
+    // half of find_or_insert(), and a probe is one key comparison or slot
+    bool counted;
+    size_t resizes;
+    size_t hits, misses;
+    double avg_probes_hit, avg_probes_miss;
+    size_t max_probes_hit, max_probes_miss;
+};
+
+// copy the recorded lookup counts into s
+inline void add_lookup_counts(TableStats& s, const LookupCounters& c) {
+    s.counted = c.enabled;
+    s.resizes = s.hits = s.misses = s.max_probes_hit = s.max_probes_miss = 0;
+    s.avg_probes_hit = s.avg_probes_miss = 0;
+#ifdef HASH_STATS
+    s.resizes = c.resizes;
+    s.hits = c.hits;
+    s.misses = c.misses;
+    s.avg_probes_hit = c.hits ? static_cast<double>(c.hit_probes) / c.hits : 0.0;
+    s.avg_probes_miss = c.misses ? static_cast<double>(c.miss_probes) / c.misses : 0.0;
+    s.max_probes_hit = c.max_hit_probes;
+    s.max_probes_miss = c.max_miss_probes;
+#endif
+}
+
+inline void write_table_stats(ostream& out, const string& name, const TableStats& s) {
+    out << "--- " << name << " (" << s.layout << ") ---\n";
+    out << "Keys: " << s.size << ", slots: " << s.slots << ", load factor: "
+        << (s.slots ? static_cast<double>(s.size) / s.slots : 0.0) << "\n";
+    out << "Bytes: " << s.bytes << ", tombstones: " << s.tombstones << "\n";
+    out << (s.layout == "chaining" ? "Chain length histogram (length: buckets)\n"
+                                   : "Probe length histogram (probes: keys)\n");
+    // chains start at length 0, probe counts at 1
+    size_t first = s.layout == "chaining" ? 0 : 1;
+    for (size_t i = 0; i < s.histogram.size(); ++i) {
+        if (s.histogram[i]) out << "  " << i + first << ": " << s.histogram[i] << "\n";
+    }
+    if (!s.counted) {
+        out << "Lookup probes and resizes: not recorded (build with make STATS=1)\n";
+        return;
+    }
+    out << "Resizes: " << s.resizes << "\n";
+    out << "Successful lookups: " << s.hits << ", avg probes " << s.avg_probes_hit
+        << ", max " << s.max_probes_hit << "\n";
+    out << "Unsuccessful lookups: " << s.misses << ", avg probes " << s.avg_probes_miss
+        << ", max " << s.max_probes_miss << "\n";
+}
+
+#endif // TABLE_STATS_H
@@ -0,0 +1,145 @@
+#ifndef TEXT_STREAM_H
+#define TEXT_STREAM_H
+
+#include "TextUtils.h"
+#include "Sections.h"
+#include <istream>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+using namespace std;
+
+// Totals the streaming pipeline gathers on the way through.
+struct StreamStats {
+    size_t bytes;
+    size_t tokens;
+    size_t sentences;
+    size_t sections;
+};
+
+// Reads a text in fixed-size chunks and feeds tokens, section numbers and
+// sentence counts through as it goes, so memory is bounded by the chunk
+// size plus whatever the token callback keeps (for a WordCounter, the
+// vocabulary) rather than by the input size.
+//
+// Each chunk is cut after its last newline and the rest is carried into the
+// next one, so a line is never split and section_heading() sees the same
+// lines find_sections() does. A line longer than a whole chunk is cut after
+// its last whitespace instead; the next chunk then starts mid-line, which
+// the at-line-start flag carries over. The Gutenberg markers are found first
+// with a cheap chunked scan that overlaps chunks by one marker length, with
+// the same fall back to the whole text as gutenberg_body(); input that
+// can't seek (a pipe) is taken whole.
+class TextStream {
+public:
+    explicit TextStream(istream& in, size_t chunk_size = 1 << 20)
+      : in(in), chunk_size(chunk_size) {}
+
+    // fn(string_view token, int section); the view is only good until fn
+    // returns. section counts the headings seen so far, so it numbers the
+    // sections as find_sections() does; a heading's own tokens go with the
+    // section it starts.
+    template<typename Fn>
+    StreamStats run(Fn fn) {
+        StreamStats stats = {0, 0, 0, 0};
+        size_t remaining = string::npos;
+        find_body(remaining);
+
+        string buf;
+        int section = 0;
+        bool line_start = true;  // buf starts at the start of a line
+        bool done = false;
+        while (!done) {
+            size_t old = buf.size();
+            size_t want = min(chunk_size, remaining);
+            buf.resize(old + want);
+            in.read(&buf[old], want);
+            size_t got = static_cast<size_t>(in.gcount());
+            buf.resize(old + got);
+            if (remaining != string::npos) remaining -= got;
+            done = got < want || remaining == 0;
+
+            size_t cut = buf.size();
+            bool cut_mid_line = false;
+            if (!done) {
+                size_t nl = buf.rfind('\n');
+                if (nl != string::npos) {
+                    cut = nl + 1;
+                } else {
+                    size_t ws = buf.find_last_of(" \t\r\f\v");
+                    cut = (ws == string::npos) ? 0 : ws + 1;
+                    cut_mid_line = cut > 0;
+                }
+            }
+            string_view part(buf.data(), cut);
+            stats.bytes += cut;
+            stats.sentences += count_sentences(part);
+            size_t pos = 0;
+            while (pos < part.size()) {
+                const char* nl = static_cast<const char*>(memchr(part.data() + pos, '\n', part.size() - pos));
+                size_t eol = nl ? nl - part.data() : part.size();
+                string_view line = part.substr(pos, eol - pos), title;
+                if (line_start && section_heading(line, title)) section++;
+                for_each_token(line, [&](string_view w) {
+                    stats.tokens++;
+                    fn(w, section);
+                });
+                line_start = true;
+                pos = eol + 1;
+            }
+            if (cut_mid_line) line_start = false;
+            buf.erase(0, cut);
+        }
+        stats.sections = section;
+        return stats;
+    }
+
+private:
+    istream& in;
+    size_t chunk_size;
+
+    // leaves the stream at the start of the body; remaining becomes the
+    // body length, or stays npos to read to the end
+    void find_body(size_t& remaining) {
+        in.clear();
+        if (!in.seekg(0)) {
+            in.clear();
+            return;
+        }
+        size_t start = scan_for(START_MARKER);
+        size_t end = scan_for(END_MARKER);
+        size_t begin = 0;
+        if (start != string::npos && end != string::npos && end > start) {
+            begin = start + START_MARKER.length();
+            remaining = end - begin;
+        }
+        in.clear();
+        in.seekg(static_cast<streamoff>(begin));
+    }
+
+    // offset of the first needle in the stream, or npos
+    size_t scan_for(const string& needle) {
+        in.clear();
+        in.seekg(0);
+        string buf;
+        size_t base = 0;
+        while (true) {
+            size_t old = buf.size();
+            buf.resize(old + chunk_size);
+            in.read(&buf[old], chunk_size);
+            buf.resize(old + static_cast<size_t>(in.gcount()));
+            size_t hit = buf.find(needle);
+            if (hit != string::npos) return base + hit;
+            if (static_cast<size_t>(in.gcount()) < chunk_size) return string::npos;
+            // keep just enough to catch a marker cut by the chunk boundary
+            size_t keep = min(buf.size(), needle.size() - 1);
+            base += buf.size() - keep;
+            buf.erase(0, buf.size() - keep);
+        }
+    }
+};
+
+#endif // TEXT_STREAM_H
@@ -0,0 +1,95 @@
+#ifndef TEXT_UTILS_H
+#define TEXT_UTILS_H
+
+#include "FinalAssignment.h"
+#include <string>
+#include <string_view>
+#include <cctype>
+#include <cstddef>
+
+using namespace std;
+
+// Function to detect section headers like I II
+inline bool is_section_header(string_view word) {
+    if (word.empty() || word.back() != '.') return false;
+    string_view roman = word.substr(0, word.size() - 1);
+    for (char c : roman) {
+        if (c != 'I' && c != 'V' && c != 'X') return false;
+    }
+    return true;
+}
+
+inline string clean_token(const string& token) {
+    string temp;
+    for (char c : token) {
+        if (isalnum(c)) temp += tolower(c);
+    }
+    return temp;
+}
+
+const string START_MARKER = "*** START OF THIS PROJECT GUTENBERG EBOOK A SCANDAL IN BOHEMIA ***";
+const string END_MARKER   = "*** END OF THIS PROJECT GUTENBERG EBOOK A SCANDAL IN BOHEMIA ***";
+
+// Extract Gutenberg body.. might help? start/end are where the markers
+// were found; falls back to the entire text.
+inline string_view gutenberg_body(string_view full_text, size_t start, size_t end) {
+    if (start != string::npos && end != string::npos && end > start) {
+        return full_text.substr(start + START_MARKER.length(),
+                                end - (start + START_MARKER.length()));
+    }
+    return full_text;
+}
+
+inline string_view gutenberg_body(string_view full_text) {
+    return gutenberg_body(full_text, full_text.find(START_MARKER), full_text.find(END_MARKER));
+}
+
+// calls fn(token) for every lowercased alphanumeric run in text, so
+// callers can count without materializing a token array. Tokens are views
+// straight into text when they're already lowercase; only tokens with
+// capitals get copied, into one reused scratch buffer. A view is only good
+// until fn returns.
+template<typename Fn>
+void for_each_token(string_view text, Fn fn) {
+    string scratch;
+    size_t i = 0, n = text.size();
+    while (i < n) {
+        while (i < n && !isalnum(static_cast<unsigned char>(text[i]))) ++i;
+        size_t start = i;
+        bool lower = true;
+        for (; i < n && isalnum(static_cast<unsigned char>(text[i])); ++i) {
+            if (isupper(static_cast<unsigned char>(text[i]))) lower = false;
+        }
+        if (i == start) break;
+        if (lower) {
+            fn(text.substr(start, i - start));
+        } else {
+            scratch.assign(text.data() + start, i - start);
+            for (char& c : scratch) c = tolower(static_cast<unsigned char>(c));
+            fn(string_view(scratch));
+        }
+    }
+}
+
+inline void tokenize(string_view text, ResizableArray<string>& tokens) {
+    for_each_token(text, [&](string_view w) { tokens.push_back(string(w)); });
+}
+
+// a search key split the same way the text is, so "Irene Adler!" gives
+// the two tokens irene, adler
+inline ResizableArray<string> key_words(string_view key) {
+    ResizableArray<string> words;
+    tokenize(key, words);
+    return words;
+}
+
+//sentence counter
+inline size_t count_sentences(string_view text) {
+    size_t count = 0;
+    for (char c : text) {
+        if (c == '.' || c == '!' || c == '?') count++;
+    }
+    return count;
+}
+
+#endif // TEXT_UTILS_H
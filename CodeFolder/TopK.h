@@ -0,0 +1,58 @@
+#ifndef TOP_K_H
+#define TOP_K_H
+
+#include "FinalAssignment.h"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+// The k entries of freq that rank first under before(a, b), best first,
+// without sorting the whole list: a heap of the k best seen so far, whose
+// top is the worst of them, so each entry costs at most one O(log k)
+// replace. O(n log k) instead of the O(n^2) selection sort.
+// Ties go to the entry earlier in freq, which for a WordCounter list is the
+// word that showed up first in the text, so the answer never depends on
+// how the selection happened to run.
+template<typename T, typename Before>
+ResizableArray<pair<T,int>> select_top_k(const ResizableArray<pair<T,int>>& freq, size_t k, Before before) {
+    auto ranks_before = [&](size_t i, size_t j) {
+        if (before(freq[i], freq[j])) return true;
+        if (before(freq[j], freq[i])) return false;
+        return i < j;
+    };
+
+    vector<size_t> heap;
+    heap.reserve(min(k, freq.size()));
+    for (size_t i = 0; i < freq.size() && k > 0; ++i) {
+        if (heap.size() < k) {
+            heap.push_back(i);
+            push_heap(heap.begin(), heap.end(), ranks_before);
+        } else if (ranks_before(i, heap.front())) {
+            pop_heap(heap.begin(), heap.end(), ranks_before);
+            heap.back() = i;
+            push_heap(heap.begin(), heap.end(), ranks_before);
+        }
+    }
+    sort_heap(heap.begin(), heap.end(), ranks_before);
+
+    ResizableArray<pair<T,int>> result;
+    for (size_t i : heap) result.push_back(freq[i]);
+    return result;
+}
+
+// k most frequent, highest count first
+template<typename T>
+ResizableArray<pair<T,int>> top_k_frequent(const ResizableArray<pair<T,int>>& freq, size_t k) {
+    return select_top_k(freq, k, [](const pair<T,int>& a, const pair<T,int>& b) { return a.second > b.second; });
+}
+
+// k least frequent, lowest count first
+template<typename T>
+ResizableArray<pair<T,int>> top_k_rare(const ResizableArray<pair<T,int>>& freq, size_t k) {
+    return select_top_k(freq, k, [](const pair<T,int>& a, const pair<T,int>& b) { return a.second < b.second; });
+}
+
+#endif // TOP_K_H
@@ -0,0 +1,58 @@
+#ifndef WORD_COUNTER_H
+#define WORD_COUNTER_H
+
+#include "FlatHash.h"
+#include "FinalAssignment.h"
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace std;
+
+// Single pass word counter. The hash index maps each word to its slot in a
+// dense array of (word, count) pairs kept in first-occurrence order, so the
+// frequency list can be handed out without walking the table. The index
+// is a FlatHash, so the per-token lookup is inlined and doubles in size
+// as the vocabulary grows.
+class WordCounter {
+public:
+    explicit WordCounter(size_t expected_words = 1024)
+      : index(static_cast<size_t>(expected_words * 100 / MAX_LOAD_PERCENT) + 1), total(0) {}
+
+    // the word is only copied the first time it is seen; n > 1 folds in
+    // counts from another counter
+    void add(string_view word, int n = 1) {
+        size_t slot = index.find_or_insert(word, freq.size());
+        if (slot == freq.size()) {
+            freq.push_back(make_pair(string(word), n));
+        } else {
+            freq[slot].second += n;
+        }
+        total += n;
+    }
+
+    void add_all(const ResizableArray<string>& tokens) {
+        for (size_t i = 0; i < tokens.size(); ++i) add(tokens[i]);
+    }
+
+    int count(const string& word) const {
+        size_t slot;
+        return index.find(word, slot) ? freq[slot].second : 0;
+    }
+
+    size_t unique_words() const { return freq.size(); }
+    size_t total_words() const { return total; }
+
+    // contiguous (word, count) array in first-occurrence order
+    const ResizableArray<pair<string,int>>& counts() const { return freq; }
+    ResizableArray<pair<string,int>> export_counts() const { return freq; }
+
+private:
+    static constexpr unsigned MAX_LOAD_PERCENT = 70;
+
+    FlatHash<string, size_t, WyHash, equal_to<>, LinearProbe, GrowingCapacity<16, MAX_LOAD_PERCENT>> index;
+    ResizableArray<pair<string,int>> freq;
+    size_t total;
+};
+
+#endif // WORD_COUNTER_H